@@ -10,7 +10,18 @@
 #include <DriverLib.h>
 #include "G8RTOS_Semaphores.h"
 #include "G8RTOS_Scheduler.h"
+#include "G8RTOS_Mutex.h"
+#include "G8RTOS_EventFlags.h"
+#include "G8RTOS_StackPool.h"
+#include "G8RTOS_MemPool.h"
+#include "G8RTOS_MsgQueue.h"
+#include "G8RTOS_SPSC.h"
+#include "G8RTOS_Timer.h"
+#include "G8RTOS_Latency.h"
+#include "G8RTOS_Instrument.h"
 #include "G8RTOS_Structures.h"
+#include "G8RTOS_Trace.h"
+#include "G8RTOS_Time.h"
 #include "G8RTOS_IPC.h"
 #include "G8RTOS_CriticalSection.h"
 
@@ -8,20 +8,52 @@
 #ifndef G8RTOS_CRITICALSECTION_H_
 #define G8RTOS_CRITICALSECTION_H_
 
+/*
+ * Highest interrupt priority (lowest number) the kernel can be called from
+ *  - Critical sections raise BASEPRI to this level, interrupts above it (priority 0, e.g. the I2C driver)
+ *    are never masked by the kernel, so they must never call kernel functions
+ *  - Calling a kernel function from above it stops in G8RTOS_KernelPriorityFault
+ *  - KERNEL_BASEPRI in G8RTOS_CriticalSection.s must match
+ */
+#define KERNEL_IRQ_PRIORITY 1
+#define KERNEL_BASEPRI (KERNEL_IRQ_PRIORITY << (8 - __NVIC_PRIO_BITS))
+
 /*
  * Starts a critical section
- * 	- Saves the state of the current PRIMASK (I-bit)
- * 	- Disables interrupts
- * Returns: The current PRIMASK State
+ * 	- Saves the state of the current BASEPRI
+ * 	- Masks interrupts at or below KERNEL_IRQ_PRIORITY
+ * Returns: The current BASEPRI State
  */
 extern int32_t StartCriticalSection();
 
 /*
  * Ends a critical Section
+ * 	- Restores the state of the BASEPRI given an input
+ * Param "IBit_State": BASEPRI State to update
+ */
+extern void EndCriticalSection(int32_t IBit_State);
+
+/*
+ * Starts a critical section that masks every interrupt
+ * 	- Saves the state of the current PRIMASK (I-bit)
+ * 	- Disables interrupts, for code that must also keep out interrupts above the kernel or sleeps with WFI
+ * Returns: The current PRIMASK State
+ */
+extern int32_t StartCriticalSectionAll();
+
+/*
+ * Ends a critical Section that masks every interrupt
  * 	- Restores the state of the PRIMASK given an input
  * Param "IBit_State": PRIMASK State to update
  */
-extern void EndCriticalSection(int32_t IBit_State);
+extern void EndCriticalSectionAll(int32_t IBit_State);
+
+/*
+ * Stops the system when a kernel function is called from an interrupt above KERNEL_IRQ_PRIORITY
+ *  - Called by StartCriticalSection, never returns
+ * Param "IRQn": interrupt that called the kernel
+ */
+void G8RTOS_KernelPriorityFault(uint32_t IRQn);
 
 
 #endif /* G8RTOS_CRITICALSECTION_H_ */
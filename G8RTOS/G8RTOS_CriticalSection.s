@@ -4,17 +4,125 @@
 
 	; Functions Defined
 	.def StartCriticalSection, EndCriticalSection
-	
+	.def StartCriticalSectionAll, EndCriticalSectionAll
+
+	; Dependencies
+	.ref G8RTOS_KernelPriorityFault, G8RTOS_ProbeRecordCaller, criticalSectionStart, criticalSectionCaller
+
 	.thumb		; Set to thumb mode
 	.align 2	; Align by 2 bytes (thumb mode uses allignment by 2 or 4)
 	.text		; Text section
-	
+
+; BASEPRI value critical sections raise to, KERNEL_IRQ_PRIORITY << (8 - __NVIC_PRIO_BITS)
+; Must match KERNEL_IRQ_PRIORITY in G8RTOS_CriticalSection.h
+KERNEL_BASEPRI .set 0x20
+
+; 1: StartCriticalSection masks every interrupt with PRIMASK (the old behaviour, to compare latencies)
+; 0: StartCriticalSection only masks interrupts the kernel can be called from, with BASEPRI
+G8RTOS_CS_PRIMASK .set 0
+
+; 1: the outermost critical section records how long it kept interrupts masked as PROBE_CRITICAL_SECTION
+;    (G8RTOS_Instrument.h), with the address it was started from so the longest one can be found,
+;    every section then costs a few more cycles
+; 0: critical sections are not timed
+G8RTOS_CS_TIMING .set 0
+
+; PROBE_CRITICAL_SECTION in probeSite_t
+PROBE_CRITICAL_SECTION .set 0
+
+; Interrupt priority registers, one byte per IRQ
+NvicIpr: .field 0xE000E400, 32
+
+; DWT cycle counter, started in G8RTOS_Init
+DwtCycCnt: .field 0xE0001004, 32
+
+; Cycle count the outermost critical section started at
+CsStartPtr: .field criticalSectionStart, 32
+
+; Return address of the StartCriticalSection call that started the outermost section
+CsCallerPtr: .field criticalSectionCaller, 32
 
 ; Starts a critical section
+;	- Faults if called from an interrupt above the kernel's priority
+; 	- Saves the state of the current BASEPRI (PRIMASK with G8RTOS_CS_PRIMASK)
+; 	- Masks interrupts at or below KERNEL_IRQ_PRIORITY
+; Returns: The current BASEPRI State
+StartCriticalSection:
+	.asmfunc
+
+	MRS R1, IPSR		; Exception number, 0 in a thread
+	SUBS R1, R1, #16	; IRQ number, negative in a thread or system exception
+	BMI CheckDone
+	LDR R2, NvicIpr
+	LDRB R2, [R2, R1]	; Priority of the active IRQ
+	CMP R2, #KERNEL_BASEPRI
+	BHS CheckDone
+	MOV R0, R1			; IRQ number as parameter
+	B G8RTOS_KernelPriorityFault	; Does not return
+
+CheckDone:
+	.if G8RTOS_CS_PRIMASK
+	MRS R0, PRIMASK		; Save PRIMASK to R0 (Return Register)
+	CPSID I				; Disable Interrupts
+	.else
+	MRS R0, BASEPRI		; Save BASEPRI to R0 (Return Register)
+	MOV R1, #KERNEL_BASEPRI
+	MSR BASEPRI_MAX, R1	; Raises BASEPRI, never lowers it inside of a nested section
+	ISB
+	.endif
+
+	.if G8RTOS_CS_TIMING
+	CBNZ R0, TimingStarted	; Nested section, the outermost one is timed
+	LDR R1, DwtCycCnt
+	LDR R1, [R1]
+	LDR R2, CsStartPtr
+	STR R1, [R2]
+	BIC R1, LR, #1		; Caller's address without the Thumb bit
+	LDR R2, CsCallerPtr
+	STR R1, [R2]
+TimingStarted:
+	.endif
+
+	BX LR				; Return
+
+	.endasmfunc
+
+; Ends a critical Section
+; 	- Restores the state of the BASEPRI (PRIMASK with G8RTOS_CS_PRIMASK) given an input
+; Param R0: BASEPRI State to update
+EndCriticalSection:
+	.asmfunc
+
+	.if G8RTOS_CS_TIMING
+	CBNZ R0, TimingDone	; Returning to an outer section, interrupts stay masked
+	PUSH {R0, LR}
+	LDR R1, DwtCycCnt
+	LDR R1, [R1]
+	LDR R2, CsStartPtr
+	LDR R2, [R2]
+	SUB R1, R1, R2		; Cycles masked as second parameter
+	LDR R2, CsCallerPtr
+	LDR R2, [R2]		; Address the section was started from as third parameter
+	MOV R0, #PROBE_CRITICAL_SECTION
+	BL G8RTOS_ProbeRecordCaller	; Still masked, it cannot be interrupted by another section
+	POP {R0, LR}
+TimingDone:
+	.endif
+
+	.if G8RTOS_CS_PRIMASK
+	MSR PRIMASK, R0		; Save R0 (Param) to PRIMASK
+	.else
+	MSR BASEPRI, R0		; Save R0 (Param) to BASEPRI
+	.endif
+	BX LR				; Return
+
+	.endasmfunc
+
+; Starts a critical section that masks every interrupt
 ; 	- Saves the state of the current PRIMASK (I-bit)
 ; 	- Disables interrupts
 ; Returns: The current PRIMASK State
-StartCriticalSection:
+StartCriticalSectionAll:
 	.asmfunc
 
 	MRS R0, PRIMASK		; Save PRIMASK to R0 (Return Register)
@@ -23,13 +131,16 @@ StartCriticalSection:
 
 	.endasmfunc
 
-; Ends a critical Section
+; Ends a critical Section that masks every interrupt
 ; 	- Restores the state of the PRIMASK given an input
 ; Param R0: PRIMASK State to update
-EndCriticalSection:
+EndCriticalSectionAll:
 	.asmfunc
-	
+
 	MSR PRIMASK, R0		; Save R0 (Param) to PRIMASK
 	BX LR				; Return
-	
-	.endasmfunc
\ No newline at end of file
+
+	.endasmfunc
+
+	.align
+	.end
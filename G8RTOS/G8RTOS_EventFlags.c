@@ -0,0 +1,178 @@
+/*
+ * G8RTOS_EventFlags.c
+ */
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+#include "msp.h"
+#include "G8RTOS.h"
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+extern tcb_t * CurrentlyRunningThread;
+
+/*********************************************** Private Functions ********************************************************************/
+
+/*
+ * Finds the flags that satisfy a wait
+ * Param "flags": flags currently set
+ * Param "mask": flags waited for
+ * Param "options": EVENT_WAIT_ANY or EVENT_WAIT_ALL
+ * Returns: flags of the mask that are set, 0 if the wait is not satisfied
+ */
+static uint32_t Satisfied(uint32_t flags, uint32_t mask, uint8_t options)
+{
+    uint32_t matched = flags & mask;
+
+    if((options & EVENT_WAIT_ALL) && (matched != mask))
+    {
+        return 0;
+    }
+
+    return matched;
+}
+
+/*********************************************** Private Functions ********************************************************************/
+
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Initializes an event group with every flag clear
+ * Param "group": Pointer to event group
+ * THIS IS A CRITICAL SECTION
+ */
+void G8RTOS_InitEventGroup(eventGroup_t *group)
+{
+    int32_t priMask = StartCriticalSection();
+
+    group->flags = 0;
+    group->waiters.head = 0;
+    group->waiters.tail = 0;
+    group->waiters.order = WAIT_FIFO;
+    group->waiters.stats.waits = 0;
+    group->waiters.stats.blockedCycles = 0;
+
+    EndCriticalSection(priMask);
+}
+
+/*
+ * Sets event flags and wakes every thread whose wait is now satisfied
+ *  - Can be called from interrupts
+ *  - Flags a woken thread asked to clear are cleared after every waiter has been checked
+ * Param "group": Pointer to event group
+ * Param "events": flags to set
+ * THIS IS A CRITICAL SECTION
+ */
+void G8RTOS_SetEvents(eventGroup_t *group, uint32_t events)
+{
+    int32_t priMask = StartCriticalSection();
+    G8RTOS_PROBE_START();
+
+    uint32_t toClear = 0;
+    tcb_t *thread = group->waiters.head;
+
+    group->flags |= events;
+
+    while(thread)
+    {
+        tcb_t *next = thread->waitNext;
+        uint32_t matched = Satisfied(group->flags, thread->eventMask, thread->eventOptions);
+
+        //Wakes thread with the flags that ended its wait
+        if(matched)
+        {
+            thread->eventResult = matched;
+
+            if(thread->eventOptions & EVENT_CLEAR_ON_EXIT)
+            {
+                toClear |= thread->eventMask;
+            }
+
+            G8RTOS_WaitQueueWakeThread(thread);
+        }
+
+        thread = next;
+    }
+
+    group->flags &= ~toClear;
+
+    //Time interrupts were masked for
+    G8RTOS_PROBE_END(PROBE_SET_EVENTS);
+
+    EndCriticalSection(priMask);
+}
+
+/*
+ * Clears event flags
+ * Param "group": Pointer to event group
+ * Param "events": flags to clear
+ * Returns: flags that were set before clearing
+ * THIS IS A CRITICAL SECTION
+ */
+uint32_t G8RTOS_ClearEvents(eventGroup_t *group, uint32_t events)
+{
+    int32_t priMask = StartCriticalSection();
+
+    uint32_t flags = group->flags;
+    group->flags &= ~events;
+
+    EndCriticalSection(priMask);
+
+    return flags;
+}
+
+/*
+ * Returns the flags currently set
+ * Param "group": Pointer to event group
+ */
+uint32_t G8RTOS_GetEvents(eventGroup_t *group)
+{
+    return group->flags;
+}
+
+/*
+ * Waits for event flags
+ *  - Returns at once if the flags are already set, otherwise blocks until they are or the timeout runs out
+ * Param "group": Pointer to event group
+ * Param "mask": flags to wait for
+ * Param "options": EVENT_WAIT_ANY or EVENT_WAIT_ALL, optionally | EVENT_CLEAR_ON_EXIT
+ * Param "timeout": ms to wait for, 0 to only check, WAIT_FOREVER to never time out
+ * Returns: flags of the mask that ended the wait, 0 if the timeout ran out
+ * THIS IS A CRITICAL SECTION
+ */
+uint32_t G8RTOS_WaitEvents(eventGroup_t *group, uint32_t mask, uint8_t options, uint32_t timeout)
+{
+    int32_t priMask = StartCriticalSection();
+
+    uint32_t matched = Satisfied(group->flags, mask, options);
+
+    //Flags already set, or caller only checks
+    if(matched || (timeout == 0))
+    {
+        if(matched && (options & EVENT_CLEAR_ON_EXIT))
+        {
+            group->flags &= ~mask;
+        }
+
+        EndCriticalSection(priMask);
+        return matched;
+    }
+
+    //Blocks until G8RTOS_SetEvents wakes it or the timeout runs out
+    tcb_t *thread = CurrentlyRunningThread;
+    thread->eventMask = mask;
+    thread->eventOptions = options;
+    thread->eventResult = 0;
+    G8RTOS_WaitQueueInsertTimeout(&group->waiters, thread, timeout);
+
+    EndCriticalSection(priMask);
+
+    //Sets PendSV flag, to yield CPU
+    SCB->ICSR |= (1<<28);
+
+    //Runs again once woken up, result is still 0 if the timeout ran out
+    return thread->eventResult;
+}
+
+/*********************************************** Public Functions *********************************************************************/
@@ -0,0 +1,80 @@
+/*
+ * G8RTOS_EventFlags.h
+ */
+
+#ifndef G8RTOS_EVENTFLAGS_H_
+#define G8RTOS_EVENTFLAGS_H_
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+/*
+ * Options of G8RTOS_WaitEvents, combined with |
+ *  - EVENT_WAIT_ANY: wait ends once any flag of the mask is set
+ *  - EVENT_WAIT_ALL: wait ends once every flag of the mask is set
+ *  - EVENT_CLEAR_ON_EXIT: flags of the mask are cleared when the wait ends
+ */
+#define EVENT_WAIT_ANY      0x00
+#define EVENT_WAIT_ALL      0x01
+#define EVENT_CLEAR_ON_EXIT 0x02
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*
+ * Event group typedef
+ *  - 32 event flags, set by threads or interrupts
+ *  - Threads wait for any or all of a set of flags, every waiter whose flags are set wakes up together
+ */
+typedef struct eventGroup_t
+{
+    uint32_t flags; //Holds set event flags
+    waitQueue_t waiters; //Holds threads waiting for flags
+}eventGroup_t;
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Initializes an event group with every flag clear
+ * Param "group": Pointer to event group
+ */
+void G8RTOS_InitEventGroup(eventGroup_t *group);
+
+/*
+ * Sets event flags and wakes every thread whose wait is now satisfied
+ *  - Can be called from interrupts
+ * Param "group": Pointer to event group
+ * Param "events": flags to set
+ */
+void G8RTOS_SetEvents(eventGroup_t *group, uint32_t events);
+
+/*
+ * Clears event flags
+ * Param "group": Pointer to event group
+ * Param "events": flags to clear
+ * Returns: flags that were set before clearing
+ */
+uint32_t G8RTOS_ClearEvents(eventGroup_t *group, uint32_t events);
+
+/*
+ * Returns the flags currently set
+ * Param "group": Pointer to event group
+ */
+uint32_t G8RTOS_GetEvents(eventGroup_t *group);
+
+/*
+ * Waits for event flags
+ *  - Returns at once if the flags are already set, otherwise blocks until they are or the timeout runs out
+ * Param "group": Pointer to event group
+ * Param "mask": flags to wait for
+ * Param "options": EVENT_WAIT_ANY or EVENT_WAIT_ALL, optionally | EVENT_CLEAR_ON_EXIT
+ * Param "timeout": ms to wait for, 0 to only check, WAIT_FOREVER to never time out
+ * Returns: flags of the mask that ended the wait, 0 if the timeout ran out
+ */
+uint32_t G8RTOS_WaitEvents(eventGroup_t *group, uint32_t mask, uint8_t options, uint32_t timeout);
+
+/*********************************************** Public Functions *********************************************************************/
+
+#endif /* G8RTOS_EVENTFLAGS_H_ */
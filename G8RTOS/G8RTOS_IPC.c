@@ -5,10 +5,10 @@
  *      Author: Daniel Gonzalez
  */
 #include <stdint.h>
+#include <string.h>
 #include "msp.h"
 #include "BSP.h"
-#include "G8RTOS_IPC.h"
-#include "G8RTOS_Semaphores.h"
+#include "G8RTOS.h"
 
 /*********************************************** Defines ******************************************************************************/
 
@@ -16,122 +16,363 @@
 
 /*********************************************** Defines ******************************************************************************/
 
+extern tcb_t * CurrentlyRunningThread;
 
 /*********************************************** Data Structures Used *****************************************************************/
 
 typedef struct FIFO_t
 {
-    int32_t buffer[FIFOSIZE];
-    int32_t *head; //Pointer to the head of the FIFO, oldest spot
-    int32_t *tail; //Pointer to the tail of the FIFO, next empty spot
+    uint8_t *buffer; //Holds elements, given by G8RTOS_CreateFIFO
+    uint32_t elementSize; //Size of an element in bytes
+    uint32_t depth; //Number of elements the buffer holds
+    uint32_t head; //Index of the head of the FIFO, oldest element
+    uint32_t tail; //Index of the tail of the FIFO, next empty spot
+    uint32_t count; //Number of elements in the FIFO
+    waitQueue_t readers; //Threads waiting for data
+    uint32_t highWater; //Most elements in the FIFO at once
+    uint32_t written; //Number of elements written
+    uint32_t read; //Number of elements read
     uint32_t lostData; //Amount of lost data
-    semaphore_t currentSize; //Semaphore to act as indicator for size
-    semaphore_t mutex; //Semaphore to indicate if FIFO is in use
 
 }FIFO_t;
 
 /* Array of FIFOS */
-static FIFO_t FIFOs[4];
+static FIFO_t FIFOs[MAX_NUMBER_OF_FIFOS];
+
+/* Storage of FIFOs made with G8RTOS_InitFIFO */
+static int32_t defaultBuffers[MAX_NUMBER_OF_FIFOS][FIFOSIZE];
 
 /*********************************************** Data Structures Used *****************************************************************/
 
+
+/*********************************************** Private Functions ********************************************************************/
+
+/*
+ * Copies elements in at the tail, wrapping at the end of the buffer
+ *  - Must be called inside of a critical section, with room for count elements
+ */
+static void CopyIn(FIFO_t *fifo, const uint8_t *data, uint32_t count)
+{
+    uint32_t first = fifo->depth - fifo->tail;
+
+    if(first > count)
+    {
+        first = count;
+    }
+
+    memcpy(&fifo->buffer[fifo->tail * fifo->elementSize], data, first * fifo->elementSize);
+    memcpy(fifo->buffer, &data[first * fifo->elementSize], (count - first) * fifo->elementSize);
+
+    fifo->tail += count;
+    if(fifo->tail >= fifo->depth)
+    {
+        fifo->tail -= fifo->depth;
+    }
+}
+
+/*
+ * Copies elements out from the head, wrapping at the end of the buffer
+ *  - Must be called inside of a critical section, with count elements in the FIFO
+ */
+static void CopyOut(FIFO_t *fifo, uint8_t *data, uint32_t count)
+{
+    uint32_t first = fifo->depth - fifo->head;
+
+    if(first > count)
+    {
+        first = count;
+    }
+
+    memcpy(data, &fifo->buffer[fifo->head * fifo->elementSize], first * fifo->elementSize);
+    memcpy(&data[first * fifo->elementSize], fifo->buffer, (count - first) * fifo->elementSize);
+
+    fifo->head += count;
+    if(fifo->head >= fifo->depth)
+    {
+        fifo->head -= fifo->depth;
+    }
+}
+
+/*********************************************** Private Functions ********************************************************************/
+
+
 /*
  * Initializes FIFO Struct
  */
 int G8RTOS_InitFIFO(uint32_t FIFOIndex)
 {
     if(FIFOIndex < MAX_NUMBER_OF_FIFOS){
-        //Initializes heads and tails
-        FIFOs[FIFOIndex].head = &FIFOs[FIFOIndex].buffer[0];
-        FIFOs[FIFOIndex].tail = &FIFOs[FIFOIndex].buffer[0];
+        return G8RTOS_CreateFIFO(FIFOIndex, defaultBuffers[FIFOIndex], FIFOSIZE, sizeof(int32_t));
+    }
+    return ERROR;
+}
 
-        FIFOs[FIFOIndex].lostData = 0;
+/*
+ * Initializes a FIFO in storage given by the caller
+ * Param "FIFOIndex": FIFO to initialize
+ * Param "buffer": storage for depth x elementSize bytes
+ * Param "depth": number of elements the FIFO holds
+ * Param "elementSize": size of an element in bytes
+ * Returns: ERROR for a bad index, depth or element size
+ * THIS IS A CRITICAL SECTION
+ */
+int G8RTOS_CreateFIFO(uint32_t FIFOIndex, void *buffer, uint32_t depth, uint32_t elementSize)
+{
+    if((FIFOIndex >= MAX_NUMBER_OF_FIFOS) || !buffer || (depth == 0) || (elementSize == 0))
+    {
+        return ERROR;
+    }
 
-        //Current size semaphore set to 0
-        G8RTOS_InitSemaphore(&FIFOs[FIFOIndex].currentSize, 0);
-        //FIFO binary semaphore set to 1
-        G8RTOS_InitSemaphore(&FIFOs[FIFOIndex].mutex, 1);
+    int32_t priMask = StartCriticalSection();
 
-        return SUCCESS;
-    }
-    return ERROR;
+    FIFO_t *fifo = &FIFOs[FIFOIndex];
+
+    fifo->buffer = buffer;
+    fifo->elementSize = elementSize;
+    fifo->depth = depth;
+
+    //Initializes heads and tails
+    fifo->head = 0;
+    fifo->tail = 0;
+    fifo->count = 0;
+
+    //Readers wake up in the order they started waiting
+    fifo->readers.head = 0;
+    fifo->readers.tail = 0;
+    fifo->readers.order = WAIT_FIFO;
+    fifo->readers.stats.waits = 0;
+    fifo->readers.stats.blockedCycles = 0;
+
+    fifo->highWater = 0;
+    fifo->written = 0;
+    fifo->read = 0;
+    fifo->lostData = 0;
+
+    EndCriticalSection(priMask);
+
+    return SUCCESS;
 }
 
 /*
  * Reads FIFO
- *  - Waits until CurrentSize semaphore is greater than zero
- *  - Gets data and increments the head ptr (wraps if necessary)
+ *  - Waits until the FIFO holds data
+ *  - Gets data and moves the head (wraps if necessary)
+ *  - For FIFOs of elements of 4 bytes or less
  * Param: "FIFOChoice": chooses which buffer we want to read from
  * Returns: uint32_t Data from FIFO
  */
 uint32_t readFIFO(uint32_t FIFOChoice)
 {
-    //Wait before reading FIFO in case of being read in another thread
-    G8RTOS_WaitSemaphore(&FIFOs[FIFOChoice].mutex);
-
-    //Wait before reading FIFO in case of empty FIFO
-    G8RTOS_WaitSemaphore(&FIFOs[FIFOChoice].currentSize);
+    uint32_t data = 0;
 
-    //Read Thread
-    uint32_t data = *(FIFOs[FIFOChoice].head);
-
-    //If head is at last index in array, then
-    if(FIFOs[FIFOChoice].head == &FIFOs[FIFOChoice].buffer[FIFOSIZE - 1])
+    if((FIFOChoice < MAX_NUMBER_OF_FIFOS) && (FIFOs[FIFOChoice].elementSize <= sizeof(data)))
     {
-        //Moves head to beginning
-        FIFOs[FIFOChoice].head = &FIFOs[FIFOChoice].buffer[0];
+        readFIFOBlock(FIFOChoice, &data, 1);
     }
-    else
+
+    return data;
+}
+
+/*
+ * Reads FIFO, waiting for at most a number of ms
+ *  - For FIFOs of elements of 4 bytes or less
+ * Param "FIFOChoice": chooses which buffer we want to read from
+ * Param "data": filled with the data read
+ * Param "timeout": ms to wait for, 0 to only check, WAIT_FOREVER to never time out
+ * Returns: ERROR if the timeout ran out
+ */
+int readFIFOTimeout(uint32_t FIFOChoice, uint32_t *data, uint32_t timeout)
+{
+    *data = 0;
+
+    if((FIFOChoice >= MAX_NUMBER_OF_FIFOS) || (FIFOs[FIFOChoice].elementSize > sizeof(*data)))
     {
-        //Increment head pointer
-        FIFOs[FIFOChoice].head++;
+        return ERROR;
     }
 
-    //Release semaphore to indicate its ready to use
-    G8RTOS_SignalSemaphore(&FIFOs[FIFOChoice].mutex);
-
-    return data;
+    return readFIFOBlockTimeout(FIFOChoice, data, 1, timeout) ? SUCCESS : ERROR;
 }
 
 /*
  * Writes to FIFO
  *  Writes data to Tail of the buffer if the buffer is not full
- *  Increments tail (wraps if ncessary)
+ *  Moves tail (wraps if ncessary)
+ *  For FIFOs of elements of 4 bytes or less, can be called from interrupts
  *  Param "FIFOChoice": chooses which buffer we want to read from
  *        "Data': Data being put into FIFO
  *  Returns: error code for full buffer if unable to write
  */
 int writeFIFO(uint32_t FIFOChoice, uint32_t Data)
 {
-    //If FIFO is full, then
-    if(FIFOs[FIFOChoice].currentSize > FIFOSIZE - 1)
+    if((FIFOChoice >= MAX_NUMBER_OF_FIFOS) || (FIFOs[FIFOChoice].elementSize > sizeof(Data)))
     {
-        //Increments lost data because it will not be saved
-        FIFOs[FIFOChoice].lostData++;
-
         return ERROR;
     }
-    else
+
+    return writeFIFOBlock(FIFOChoice, &Data, 1) ? SUCCESS : ERROR;
+}
+
+/*
+ * Reads many elements under one critical section
+ *  - Waits until the FIFO holds data, then reads as many elements as are there, up to count
+ * Param "FIFOChoice": chooses which buffer we want to read from
+ * Param "data": filled with the elements read
+ * Param "count": most elements to read
+ * Returns: number of elements read, 0 for a bad index
+ */
+uint32_t readFIFOBlock(uint32_t FIFOChoice, void *data, uint32_t count)
+{
+    return readFIFOBlockTimeout(FIFOChoice, data, count, WAIT_FOREVER);
+}
+
+/*
+ * Reads many elements under one critical section, waiting for at most a number of ms
+ *  - Waits until the FIFO holds data or the timeout runs out, the timeout waits in the sleep queue
+ *  - Wakes the next reader if data is left over
+ * Param "FIFOChoice": chooses which buffer we want to read from
+ * Param "data": filled with the elements read
+ * Param "count": most elements to read
+ * Param "timeout": ms to wait for, 0 to only check, WAIT_FOREVER to never time out
+ * Returns: number of elements read, 0 if the timeout ran out or for a bad index
+ * THIS IS A CRITICAL SECTION
+ */
+uint32_t readFIFOBlockTimeout(uint32_t FIFOChoice, void *data, uint32_t count, uint32_t timeout)
+{
+    if((FIFOChoice >= MAX_NUMBER_OF_FIFOS) || (count == 0))
+    {
+        return 0;
+    }
+
+    FIFO_t *fifo = &FIFOs[FIFOChoice];
+    uint32_t deadline = SystemTime + timeout;
+
+    int32_t priMask = StartCriticalSection();
+
+    //Blocks until a write wakes it, another reader may have emptied the FIFO again by then
+    while(fifo->count == 0)
     {
-        //Writes data in FIFO
-        *(FIFOs[FIFOChoice].tail) = Data;
+        uint32_t wait = timeout;
 
-        //If tail pointer is pointing to last index, then
-        if(FIFOs[FIFOChoice].tail == &FIFOs[FIFOChoice].buffer[FIFOSIZE-1])
+        //Waits again only for the time left
+        if(timeout != WAIT_FOREVER)
         {
-            //Moves head to beginning
-            FIFOs[FIFOChoice].tail = &FIFOs[FIFOChoice].buffer[0];
+            wait = TIME_REACHED(SystemTime, deadline) ? 0 : (deadline - SystemTime);
         }
-        else
+
+        if(wait == 0)
         {
-            //Moves head to beginning
-            FIFOs[FIFOChoice].tail++;
+            EndCriticalSection(priMask);
+            return 0;
         }
+
+        G8RTOS_WaitQueueInsertTimeout(&fifo->readers, CurrentlyRunningThread, wait);
+        EndCriticalSection(priMask);
+
+        //Sets PendSV flag, to yield CPU
+        SCB->ICSR |= (1<<28);
+
+        priMask = StartCriticalSection();
+    }
+
+    if(count > fifo->count)
+    {
+        count = fifo->count;
     }
 
-    //Signal current size semaphore
-    G8RTOS_SignalSemaphore(&FIFOs[FIFOChoice].currentSize);
+    CopyOut(fifo, data, count);
+    fifo->count -= count;
+    fifo->read += count;
 
-    return SUCCESS;
+    if(fifo->count)
+    {
+        G8RTOS_WaitQueueWake(&fifo->readers);
+    }
+
+    G8RTOS_TRACE_EVENT(TRACE_FIFO_READ, 0, FIFOChoice);
+
+    EndCriticalSection(priMask);
+
+    return count;
+}
+
+/*
+ * Writes many elements under one critical section
+ *  - Writes as many elements as fit, the rest are dropped and counted as lost data
+ *  - Wakes the first waiting reader
+ *  - Can be called from interrupts
+ * Param "FIFOChoice": chooses which buffer we want to write to
+ * Param "data": elements to write
+ * Param "count": number of elements to write
+ * Returns: number of elements written
+ * THIS IS A CRITICAL SECTION
+ */
+uint32_t writeFIFOBlock(uint32_t FIFOChoice, const void *data, uint32_t count)
+{
+    if(FIFOChoice >= MAX_NUMBER_OF_FIFOS)
+    {
+        return 0;
+    }
+
+    FIFO_t *fifo = &FIFOs[FIFOChoice];
+
+    int32_t priMask = StartCriticalSection();
+
+    uint32_t room = fifo->depth - fifo->count;
+
+    //Increments lost data for what will not be saved
+    if(count > room)
+    {
+        fifo->lostData += count - room;
+        count = room;
+    }
+
+    if(count)
+    {
+        CopyIn(fifo, data, count);
+        fifo->count += count;
+        fifo->written += count;
+
+        if(fifo->count > fifo->highWater)
+        {
+            fifo->highWater = fifo->count;
+        }
+
+        G8RTOS_WaitQueueWake(&fifo->readers);
+        G8RTOS_TRACE_EVENT(TRACE_FIFO_WRITE, 0, FIFOChoice);
+    }
+
+    EndCriticalSection(priMask);
+
+    return count;
 }
 
+/*
+ * Copies the usage of a FIFO
+ * Param "FIFOChoice": chooses which FIFO
+ * Param "stats": struct to fill
+ * Returns: ERROR for a bad index
+ */
+int G8RTOS_GetFIFOStats(uint32_t FIFOChoice, fifoStats_t *stats)
+{
+    if(FIFOChoice >= MAX_NUMBER_OF_FIFOS)
+    {
+        return ERROR;
+    }
+
+    FIFO_t *fifo = &FIFOs[FIFOChoice];
+
+    int32_t priMask = StartCriticalSection();
+
+    stats->depth = fifo->depth;
+    stats->elementSize = fifo->elementSize;
+    stats->count = fifo->count;
+    stats->highWater = fifo->highWater;
+    stats->written = fifo->written;
+    stats->read = fifo->read;
+    stats->lostData = fifo->lostData;
+    stats->readerWaits = fifo->readers.stats;
+
+    EndCriticalSection(priMask);
+
+    return SUCCESS;
+}
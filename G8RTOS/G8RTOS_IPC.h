@@ -8,39 +8,124 @@
 #ifndef G8RTOS_G8RTOS_IPC_H_
 #define G8RTOS_G8RTOS_IPC_H_
 
+/* Depth of the FIFOs G8RTOS_InitFIFO makes, in 32-bit words */
 #define FIFOSIZE 16
+
+/* FIFO indexes available, can be raised from the build options */
+#ifndef MAX_NUMBER_OF_FIFOS
 #define MAX_NUMBER_OF_FIFOS 4
+#endif
 
 /*********************************************** Error Codes **************************************************************************/
 
 /*********************************************** Error Codes **************************************************************************/
 
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*
+ * Usage of a FIFO, counts are in elements
+ */
+typedef struct fifoStats_t
+{
+    uint32_t depth; //Holds number of elements the FIFO holds
+    uint32_t elementSize; //Holds size of an element in bytes
+    uint32_t count; //Holds number of elements in the FIFO now
+    uint32_t highWater; //Holds most elements in the FIFO at once
+    uint32_t written; //Holds number of elements written
+    uint32_t read; //Holds number of elements read
+    uint32_t lostData; //Holds number of elements dropped because the FIFO was full
+    waitStats_t readerWaits; //Holds number of times readers blocked on an empty FIFO, and for how long
+}fifoStats_t;
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
 /*********************************************** Public Functions *********************************************************************/
 
 /*
  * Initializes One to One FIFO Struct
+ *  - FIFOSIZE 32-bit words, in storage kept by the kernel
  */
 int G8RTOS_InitFIFO(uint32_t FIFOIndex);
 
+/*
+ * Initializes a FIFO in storage given by the caller
+ * Param "FIFOIndex": FIFO to initialize
+ * Param "buffer": storage for depth x elementSize bytes
+ * Param "depth": number of elements the FIFO holds
+ * Param "elementSize": size of an element in bytes
+ * Returns: ERROR for a bad index, depth or element size
+ */
+int G8RTOS_CreateFIFO(uint32_t FIFOIndex, void *buffer, uint32_t depth, uint32_t elementSize);
+
 /*
  * Reads FIFO
- *  - Waits until CurrentSize semaphore is greater than zero
- *  - Gets data and increments the head ptr (wraps if necessary)
+ *  - Waits until the FIFO holds data
+ *  - For FIFOs of elements of 4 bytes or less
  * Param "FIFOChoice": chooses which buffer we want to read from
  * Returns: uint32_t Data from FIFO
  */
 uint32_t readFIFO(uint32_t FIFO);
 
+/*
+ * Reads FIFO, waiting for at most a number of ms
+ *  - For FIFOs of elements of 4 bytes or less
+ * Param "FIFOChoice": chooses which buffer we want to read from
+ * Param "data": filled with the data read
+ * Param "timeout": ms to wait for, 0 to only check, WAIT_FOREVER to never time out
+ * Returns: ERROR if the timeout ran out
+ */
+int readFIFOTimeout(uint32_t FIFO, uint32_t *data, uint32_t timeout);
+
 /*
  * Writes to FIFO
  *  Writes data to Tail of the buffer if the buffer is not full
- *  Increments tail (wraps if ncessary)
+ *  For FIFOs of elements of 4 bytes or less, can be called from interrupts
  *  Param "FIFOChoice": chooses which buffer we want to read from
  *        "Data': Data being put into FIFO
  *  Returns: error code for full buffer if unable to write
  */
 int writeFIFO(uint32_t FIFO, uint32_t data);
 
+/*
+ * Reads many elements under one critical section
+ *  - Waits until the FIFO holds data, then reads as many elements as are there, up to count
+ * Param "FIFOChoice": chooses which buffer we want to read from
+ * Param "data": filled with the elements read
+ * Param "count": most elements to read
+ * Returns: number of elements read, 0 for a bad index
+ */
+uint32_t readFIFOBlock(uint32_t FIFO, void *data, uint32_t count);
+
+/*
+ * Reads many elements under one critical section, waiting for at most a number of ms
+ *  - Waits until the FIFO holds data or the timeout runs out, the timeout waits in the sleep queue
+ * Param "FIFOChoice": chooses which buffer we want to read from
+ * Param "data": filled with the elements read
+ * Param "count": most elements to read
+ * Param "timeout": ms to wait for, 0 to only check, WAIT_FOREVER to never time out
+ * Returns: number of elements read, 0 if the timeout ran out or for a bad index
+ */
+uint32_t readFIFOBlockTimeout(uint32_t FIFO, void *data, uint32_t count, uint32_t timeout);
+
+/*
+ * Writes many elements under one critical section
+ *  - Writes as many elements as fit, the rest are dropped and counted as lost data
+ *  - Can be called from interrupts
+ * Param "FIFOChoice": chooses which buffer we want to write to
+ * Param "data": elements to write
+ * Param "count": number of elements to write
+ * Returns: number of elements written
+ */
+uint32_t writeFIFOBlock(uint32_t FIFO, const void *data, uint32_t count);
+
+/*
+ * Copies the usage of a FIFO
+ * Param "FIFOChoice": chooses which FIFO
+ * Param "stats": struct to fill
+ * Returns: ERROR for a bad index
+ */
+int G8RTOS_GetFIFOStats(uint32_t FIFO, fifoStats_t *stats);
+
 /*********************************************** Public Functions *********************************************************************/
 
 
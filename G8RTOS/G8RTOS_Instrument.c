@@ -0,0 +1,215 @@
+/*
+ * G8RTOS_Instrument.c
+ */
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+#include "msp.h"
+#include "BSP.h"
+#include "G8RTOS.h"
+#include <stdio.h>
+#include <string.h>
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+/* Statistics of every probe site */
+static probeStats_t probes[NUMBER_OF_PROBE_SITES];
+
+/* Cycle count the outermost critical section started at, written by StartCriticalSection with G8RTOS_CS_TIMING */
+uint32_t criticalSectionStart;
+
+/* Address the outermost critical section was started from, written by StartCriticalSection with G8RTOS_CS_TIMING */
+uint32_t criticalSectionCaller;
+
+/* Names printed in the report, in probeSite_t order */
+static const char *probeNames[NUMBER_OF_PROBE_SITES] =
+{
+    "criticalSection",
+    "sysTick",
+    "sysTickLatency",
+    "pendSV",
+    "isrLatency",
+    "addThread",
+    "killThread",
+    "signalSemaphore",
+    "setEvents"
+};
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Adds a sample to a probe site
+ *  - Can be called from any interrupt and from inside of critical sections, it masks with PRIMASK
+ *    (StartCriticalSection may itself be timed, so it is not used here)
+ * Param "site": probe site
+ * Param "cycles": measured clock cycles
+ * THIS IS A CRITICAL SECTION
+ */
+void G8RTOS_ProbeRecord(probeSite_t site, uint32_t cycles)
+{
+    G8RTOS_ProbeRecordCaller(site, cycles, 0);
+}
+
+/*
+ * Adds a sample to a probe site along with the code address it was taken for
+ *  - The address of the longest sample is kept, G8RTOS_PrintProbeReport prints it for addr2line or the map file
+ *  - Called by EndCriticalSection with G8RTOS_CS_TIMING, masks with PRIMASK like G8RTOS_ProbeRecord
+ * Param "site": probe site
+ * Param "cycles": measured clock cycles
+ * Param "caller": code address that started the measured path
+ * THIS IS A CRITICAL SECTION
+ */
+void G8RTOS_ProbeRecordCaller(probeSite_t site, uint32_t cycles, uint32_t caller)
+{
+    int32_t priMask = StartCriticalSectionAll();
+
+    probeStats_t *probe = &probes[site];
+
+    if((probe->count == 0) || (cycles < probe->minCycles))
+    {
+        probe->minCycles = cycles;
+    }
+    if(cycles > probe->maxCycles)
+    {
+        probe->maxCycles = cycles;
+        probe->maxCaller = caller;
+    }
+
+    probe->count++;
+    probe->totalCycles += cycles;
+
+    //Bucket is the number of significant bits
+    uint32_t bucket = 32 - __CLZ(cycles);
+    if(bucket >= PROBE_BUCKETS)
+    {
+        bucket = PROBE_BUCKETS - 1;
+    }
+    probe->histogram[bucket]++;
+
+    EndCriticalSectionAll(priMask);
+}
+
+/*
+ * Copies the statistics of a probe site
+ * Param "site": probe site
+ * Param "stats": struct to fill
+ */
+void G8RTOS_GetProbeStats(probeSite_t site, probeStats_t *stats)
+{
+    int32_t priMask = StartCriticalSectionAll();
+    *stats = probes[site];
+    EndCriticalSectionAll(priMask);
+}
+
+/*
+ * Clears the samples of every probe site, budgets are kept
+ */
+void G8RTOS_ResetProbes(void)
+{
+    int32_t priMask = StartCriticalSectionAll();
+
+    for(uint32_t i = 0; i < NUMBER_OF_PROBE_SITES; ++i)
+    {
+        uint32_t budget = probes[i].budgetCycles;
+        memset(&probes[i], 0, sizeof(probeStats_t));
+        probes[i].budgetCycles = budget;
+    }
+
+    EndCriticalSectionAll(priMask);
+}
+
+/*
+ * Sets the longest sample a probe site may record before G8RTOS_CheckProbeBudgets reports it
+ * Param "site": probe site
+ * Param "cycles": budget, 0 for no limit
+ */
+void G8RTOS_SetProbeBudget(probeSite_t site, uint32_t cycles)
+{
+    probes[site].budgetCycles = cycles;
+}
+
+/*
+ * Checks the longest sample of every probe site against its budget
+ *  - Prints a warning to the back channel UART for every site over budget
+ * Returns: number of sites over budget, 0 when no kernel path got slower than allowed
+ */
+uint32_t G8RTOS_CheckProbeBudgets(void)
+{
+    probeStats_t stats;
+    char line[64];
+    uint32_t over = 0;
+
+    for(uint32_t i = 0; i < NUMBER_OF_PROBE_SITES; ++i)
+    {
+        G8RTOS_GetProbeStats((probeSite_t)i, &stats);
+
+        if(stats.budgetCycles && (stats.maxCycles > stats.budgetCycles))
+        {
+            snprintf(line, sizeof(line), "%s over budget: max %u > %u cycles",
+                     probeNames[i], stats.maxCycles, stats.budgetCycles);
+            BackChannelPrint(line, BackChannel_Warning);
+            over++;
+        }
+    }
+
+    return over;
+}
+
+/*
+ * Prints the statistics of every probe site with samples to the back channel UART
+ *  - One line of count, min, average and max, and one line of the non-empty histogram buckets
+ */
+void G8RTOS_PrintProbeReport(void)
+{
+    probeStats_t stats;
+    char line[96];
+
+    BackChannelPrint("site             count      min      avg      max", BackChannel_Info);
+
+    for(uint32_t i = 0; i < NUMBER_OF_PROBE_SITES; ++i)
+    {
+        G8RTOS_GetProbeStats((probeSite_t)i, &stats);
+
+        if(stats.count == 0)
+        {
+            continue;
+        }
+
+        snprintf(line, sizeof(line), "%-16s %5u %8u %8u %8u", probeNames[i], stats.count,
+                 stats.minCycles, (uint32_t)(stats.totalCycles / stats.count), stats.maxCycles);
+        BackChannelPrint(line, BackChannel_Info);
+
+        //Code the longest sample came from
+        if(stats.maxCaller)
+        {
+            snprintf(line, sizeof(line), "  max at 0x%08x", stats.maxCaller);
+            BackChannelPrint(line, BackChannel_Info);
+        }
+
+        //Buckets as <upper bound>:<samples>
+        int32_t length = snprintf(line, sizeof(line), "  hist");
+        for(uint32_t b = 0; b < PROBE_BUCKETS; ++b)
+        {
+            if(stats.histogram[b] && (length < (int32_t)sizeof(line)))
+            {
+                if(b == PROBE_BUCKETS - 1)
+                {
+                    length += snprintf(&line[length], sizeof(line) - length, " >=%u:%u", 1u << (b - 1), stats.histogram[b]);
+                }
+                else
+                {
+                    length += snprintf(&line[length], sizeof(line) - length, " <%u:%u", 1u << b, stats.histogram[b]);
+                }
+            }
+        }
+        BackChannelPrint(line, BackChannel_Info);
+    }
+}
+
+/*********************************************** Public Functions *********************************************************************/
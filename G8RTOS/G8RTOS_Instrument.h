@@ -0,0 +1,130 @@
+/*
+ * G8RTOS_Instrument.h
+ */
+
+#ifndef G8RTOS_INSTRUMENT_H_
+#define G8RTOS_INSTRUMENT_H_
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+/*
+ * Histogram buckets of each probe site
+ *  - Bucket 0 holds 0 cycles, bucket n holds 2^(n-1) to 2^n - 1 cycles, the last bucket holds everything above
+ */
+#define PROBE_BUCKETS 16
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*
+ * Measured kernel paths
+ *  - PROBE_CRITICAL_SECTION: time interrupts stay masked by the outermost critical section, the longest is kept
+ *    with the address it was started from (only recorded with G8RTOS_CS_TIMING set in G8RTOS_CriticalSection.s)
+ *  - PROBE_SYSTICK_LATENCY: time from the tick to SysTick_Handler running
+ *  - PROBE_ISR_LATENCY: time from the latency probe timer (G8RTOS_StartLatencyProbe) to its handler running
+ *  - PROBE_ADD_THREAD to PROBE_SET_EVENTS: time the kernel function keeps interrupts masked
+ *  - The rest are the duration of a handler
+ */
+typedef enum
+{
+    PROBE_CRITICAL_SECTION = 0,
+    PROBE_SYSTICK,
+    PROBE_SYSTICK_LATENCY,
+    PROBE_PENDSV,
+    PROBE_ISR_LATENCY,
+    PROBE_ADD_THREAD,
+    PROBE_KILL_THREAD,
+    PROBE_SIGNAL_SEMAPHORE,
+    PROBE_SET_EVENTS,
+    NUMBER_OF_PROBE_SITES
+}probeSite_t;
+
+/*
+ * Statistics of one probe site, in clock cycles
+ */
+typedef struct probeStats_t
+{
+    uint32_t count; //Holds number of samples
+    uint32_t minCycles; //Holds shortest sample
+    uint32_t maxCycles; //Holds longest sample
+    uint64_t totalCycles; //Holds sum of every sample
+    uint32_t budgetCycles; //Holds longest sample allowed by G8RTOS_CheckProbeBudgets, 0 for no limit
+    uint32_t maxCaller; //Holds code address the longest sample was taken for, 0 if the site does not record one
+    uint32_t histogram[PROBE_BUCKETS]; //Holds number of samples per power of two bucket
+}probeStats_t;
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+/*
+ * Times a kernel path, compiles to nothing unless G8RTOS_INSTRUMENT is 1
+ *  - G8RTOS_PROBE_START() at the start of the path, G8RTOS_PROBE_END(site) where it ends
+ */
+#if G8RTOS_INSTRUMENT
+#define G8RTOS_PROBE_START() uint32_t probeStartCycles = DWT->CYCCNT
+#define G8RTOS_PROBE_END(site) G8RTOS_ProbeRecord((site), DWT->CYCCNT - probeStartCycles)
+#define G8RTOS_PROBE_SAMPLE(site, cycles) G8RTOS_ProbeRecord((site), (cycles))
+#else
+#define G8RTOS_PROBE_START()
+#define G8RTOS_PROBE_END(site)
+#define G8RTOS_PROBE_SAMPLE(site, cycles)
+#endif
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Adds a sample to a probe site
+ *  - Can be called from any interrupt and from inside of critical sections, it masks with PRIMASK
+ * Param "site": probe site
+ * Param "cycles": measured clock cycles
+ */
+void G8RTOS_ProbeRecord(probeSite_t site, uint32_t cycles);
+
+/*
+ * Adds a sample to a probe site along with the code address it was taken for
+ *  - The address of the longest sample is kept, G8RTOS_PrintProbeReport prints it for addr2line or the map file
+ * Param "site": probe site
+ * Param "cycles": measured clock cycles
+ * Param "caller": code address that started the measured path
+ */
+void G8RTOS_ProbeRecordCaller(probeSite_t site, uint32_t cycles, uint32_t caller);
+
+/*
+ * Copies the statistics of a probe site
+ * Param "site": probe site
+ * Param "stats": struct to fill
+ */
+void G8RTOS_GetProbeStats(probeSite_t site, probeStats_t *stats);
+
+/*
+ * Clears the samples of every probe site, budgets are kept
+ */
+void G8RTOS_ResetProbes(void);
+
+/*
+ * Sets the longest sample a probe site may record before G8RTOS_CheckProbeBudgets reports it
+ * Param "site": probe site
+ * Param "cycles": budget, 0 for no limit
+ */
+void G8RTOS_SetProbeBudget(probeSite_t site, uint32_t cycles);
+
+/*
+ * Checks the longest sample of every probe site against its budget
+ *  - Prints a warning to the back channel UART for every site over budget
+ * Returns: number of sites over budget, 0 when no kernel path got slower than allowed
+ */
+uint32_t G8RTOS_CheckProbeBudgets(void);
+
+/*
+ * Prints the statistics of every probe site with samples to the back channel UART
+ *  - One line of count, min, average and max, and one line of the non-empty histogram buckets
+ */
+void G8RTOS_PrintProbeReport(void);
+
+/*********************************************** Public Functions *********************************************************************/
+
+#endif /* G8RTOS_INSTRUMENT_H_ */
@@ -0,0 +1,115 @@
+/*
+ * G8RTOS_Latency.c
+ */
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+#include "msp.h"
+#include "BSP.h"
+#include "G8RTOS.h"
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+/* Written by the probe interrupt only */
+static volatile latencyStats_t latencyStats;
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+
+/*********************************************** Private Functions ********************************************************************/
+
+/*
+ * Probe interrupt
+ *  - The timer reloads when it expires and keeps counting down, so the cycles it counted since are the latency
+ *  - Runs above the kernel, so it must not call kernel functions
+ */
+static void LatencyProbe(void)
+{
+    uint32_t cycles = LATENCY_PROBE_PERIOD - TIMER32_2->VALUE;
+
+    TIMER32_2->INTCLR = 0;
+
+    latencyStats.samples++;
+    latencyStats.lastCycles = cycles;
+    if(cycles > latencyStats.maxCycles)
+    {
+        latencyStats.maxCycles = cycles;
+    }
+
+    G8RTOS_PROBE_SAMPLE(PROBE_ISR_LATENCY, cycles);
+}
+
+/*********************************************** Private Functions ********************************************************************/
+
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Starts the interrupt latency probe on Timer32 2
+ *  - The probe interrupt runs at a chosen priority and only reads the timer, it never calls the kernel
+ *  - Priority 0 measures the latency the I2C interrupt sees
+ * Param "priority": NVIC priority of the probe interrupt
+ */
+void G8RTOS_StartLatencyProbe(uint8_t priority)
+{
+    latencyStats.samples = 0;
+    latencyStats.lastCycles = 0;
+    latencyStats.maxCycles = 0;
+
+    //Periodic 32-bit timer at the CPU clock
+    TIMER32_2->CONTROL = 0;
+    TIMER32_2->LOAD = LATENCY_PROBE_PERIOD;
+    TIMER32_2->INTCLR = 0;
+
+    __NVIC_SetVector(T32_INT2_IRQn, (uint32_t)LatencyProbe);
+    __NVIC_SetPriority(T32_INT2_IRQn, priority);
+    __NVIC_EnableIRQ(T32_INT2_IRQn);
+
+    TIMER32_2->CONTROL = TIMER32_CONTROL_SIZE | TIMER32_CONTROL_MODE | TIMER32_CONTROL_IE | TIMER32_CONTROL_ENABLE;
+}
+
+/*
+ * Stops the interrupt latency probe
+ */
+void G8RTOS_StopLatencyProbe(void)
+{
+    TIMER32_2->CONTROL = 0;
+    __NVIC_DisableIRQ(T32_INT2_IRQn);
+}
+
+/*
+ * Copies the probe's latency statistics, then restarts them
+ *  - Masks every interrupt, the probe itself may run above the kernel
+ * Param "stats": struct to fill
+ */
+void G8RTOS_GetLatencyStats(latencyStats_t *stats)
+{
+    int32_t priMask = StartCriticalSectionAll();
+
+    stats->samples = latencyStats.samples;
+    stats->lastCycles = latencyStats.lastCycles;
+    stats->maxCycles = latencyStats.maxCycles;
+
+    latencyStats.samples = 0;
+    latencyStats.maxCycles = 0;
+
+    EndCriticalSectionAll(priMask);
+}
+
+/*
+ * Prints the probe's latency statistics to the back channel UART, then restarts them
+ */
+void G8RTOS_PrintLatencyStats(void)
+{
+    latencyStats_t stats;
+
+    G8RTOS_GetLatencyStats(&stats);
+
+    BackChannelPrintIntVariable("latencySamples", stats.samples);
+    BackChannelPrintIntVariable("latencyMaxCycles", stats.maxCycles);
+}
+
+/*********************************************** Public Functions *********************************************************************/
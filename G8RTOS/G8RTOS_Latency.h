@@ -0,0 +1,61 @@
+/*
+ * G8RTOS_Latency.h
+ */
+
+#ifndef G8RTOS_LATENCY_H_
+#define G8RTOS_LATENCY_H_
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+/*
+ * Cycles between probe interrupts
+ *  - Not a multiple of the SysTick period, so samples land at every point of the kernel's work
+ */
+#define LATENCY_PROBE_PERIOD 65537
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*
+ * Interrupt latency statistics, in clock cycles
+ *  - Latency is the time from the probe timer expiring to its handler running
+ */
+typedef struct latencyStats_t
+{
+    uint32_t samples; //Holds number of probe interrupts
+    uint32_t lastCycles; //Holds latency of the last probe interrupt
+    uint32_t maxCycles; //Holds worst latency seen
+}latencyStats_t;
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Starts the interrupt latency probe on Timer32 2
+ *  - The probe interrupt runs at a chosen priority and only reads the timer, it never calls the kernel
+ *  - Priority 0 measures the latency the I2C interrupt sees
+ * Param "priority": NVIC priority of the probe interrupt
+ */
+void G8RTOS_StartLatencyProbe(uint8_t priority);
+
+/*
+ * Stops the interrupt latency probe
+ */
+void G8RTOS_StopLatencyProbe(void);
+
+/*
+ * Copies the probe's latency statistics, then restarts them
+ * Param "stats": struct to fill
+ */
+void G8RTOS_GetLatencyStats(latencyStats_t *stats);
+
+/*
+ * Prints the probe's latency statistics to the back channel UART, then restarts them
+ */
+void G8RTOS_PrintLatencyStats(void);
+
+/*********************************************** Public Functions *********************************************************************/
+
+#endif /* G8RTOS_LATENCY_H_ */
@@ -0,0 +1,238 @@
+/*
+ * G8RTOS_MemPool.c
+ */
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+#include "msp.h"
+#include "BSP.h"
+#include "G8RTOS.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+extern tcb_t * CurrentlyRunningThread;
+
+/*********************************************** Defines ******************************************************************************/
+
+/* Blocks used by G8RTOS_MemPoolBenchmark */
+#define BENCH_BLOCK_SIZE  32
+#define BENCH_BLOCK_COUNT 4
+
+/*********************************************** Defines ******************************************************************************/
+
+
+/*********************************************** Private Functions ********************************************************************/
+
+/*
+ * Takes the first free block
+ *  - Must be called inside of a critical section
+ * Returns: the block, 0 if the pool is empty
+ */
+static void *Take(memPool_t *pool)
+{
+    uint32_t *block = pool->freeList;
+
+    if(!block)
+    {
+        pool->stats.failures++;
+        return 0;
+    }
+
+    pool->freeList = *(uint32_t **)block;
+
+    pool->stats.inUse++;
+    if(pool->stats.inUse > pool->stats.peak)
+    {
+        pool->stats.peak = pool->stats.inUse;
+    }
+
+    return block;
+}
+
+/*********************************************** Private Functions ********************************************************************/
+
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Carves a buffer into free blocks
+ * Param "pool": Pointer to memory pool
+ * Param "buffer": storage declared with MEMPOOL_BUFFER
+ * Param "blockSize": size of each block in bytes
+ * Param "blockCount": number of blocks the buffer holds
+ * THIS IS A CRITICAL SECTION
+ */
+void G8RTOS_InitMemPool(memPool_t *pool, uint32_t *buffer, uint32_t blockSize, uint32_t blockCount)
+{
+    int32_t priMask = StartCriticalSection();
+
+    uint32_t words = MEMPOOL_BLOCK_WORDS(blockSize);
+
+    //Every block must hold the free list link
+    if(words == 0)
+    {
+        words = 1;
+    }
+
+    pool->freeList = 0;
+    pool->waiters.head = 0;
+    pool->waiters.tail = 0;
+    pool->waiters.order = WAIT_PRIORITY;
+    pool->waiters.stats.waits = 0;
+    pool->waiters.stats.blockedCycles = 0;
+    pool->stats.blockSize = words * 4;
+    pool->stats.total = blockCount;
+    pool->stats.inUse = 0;
+    pool->stats.peak = 0;
+    pool->stats.failures = 0;
+
+    //Links blocks last to first, so the first block is given out first
+    for(uint32_t i = blockCount; i > 0; --i)
+    {
+        uint32_t *block = &buffer[(i - 1) * words];
+        *(uint32_t **)block = pool->freeList;
+        pool->freeList = block;
+    }
+
+    EndCriticalSection(priMask);
+}
+
+/*
+ * Takes a block without blocking
+ *  - Can be called from interrupts
+ * Param "pool": Pointer to memory pool
+ * Returns: the block, 0 if the pool is empty
+ * THIS IS A CRITICAL SECTION
+ */
+void *G8RTOS_MemPoolAlloc(memPool_t *pool)
+{
+    int32_t priMask = StartCriticalSection();
+    void *block = Take(pool);
+    EndCriticalSection(priMask);
+
+    return block;
+}
+
+/*
+ * Takes a block, blocking while the pool is empty
+ *  - Threads only
+ * Param "pool": Pointer to memory pool
+ * Param "timeout": ms to wait for, 0 to only check, WAIT_FOREVER to never time out
+ * Returns: the block, 0 if the timeout ran out
+ * THIS IS A CRITICAL SECTION
+ */
+void *G8RTOS_MemPoolAllocWait(memPool_t *pool, uint32_t timeout)
+{
+    int32_t priMask = StartCriticalSection();
+
+    void *block = Take(pool);
+
+    //Block free, or caller only checks
+    if(block || (timeout == 0))
+    {
+        EndCriticalSection(priMask);
+        return block;
+    }
+
+    //Blocks until G8RTOS_MemPoolFree hands it a block or the timeout runs out
+    tcb_t *thread = CurrentlyRunningThread;
+    thread->waitData = 0;
+    G8RTOS_WaitQueueInsertTimeout(&pool->waiters, thread, timeout);
+
+    EndCriticalSection(priMask);
+
+    //Sets PendSV flag, to yield CPU
+    SCB->ICSR |= (1<<28);
+
+    //Runs again once woken up, still 0 if the timeout ran out
+    return thread->waitData;
+}
+
+/*
+ * Gives a block back to its pool
+ *  - Can be called from interrupts
+ * Param "pool": Pointer to memory pool
+ * Param "block": block taken from the same pool
+ * THIS IS A CRITICAL SECTION
+ */
+void G8RTOS_MemPoolFree(memPool_t *pool, void *block)
+{
+    int32_t priMask = StartCriticalSection();
+
+    tcb_t *thread = pool->waiters.head;
+
+    //Hands the block straight to a waiting thread, it stays in use
+    if(thread)
+    {
+        thread->waitData = block;
+        G8RTOS_WaitQueueWakeThread(thread);
+    }
+    else
+    {
+        *(uint32_t **)block = pool->freeList;
+        pool->freeList = block;
+        pool->stats.inUse--;
+    }
+
+    EndCriticalSection(priMask);
+}
+
+/*
+ * Copies the usage of a memory pool
+ * Param "pool": Pointer to memory pool
+ * Param "stats": struct to fill
+ */
+void G8RTOS_GetMemPoolStats(memPool_t *pool, memPoolStats_t *stats)
+{
+    int32_t priMask = StartCriticalSection();
+    *stats = pool->stats;
+    EndCriticalSection(priMask);
+}
+
+/*
+ * Measures allocation throughput and prints it to the back channel UART
+ *  - Times alloc/free pairs on a pool and on the C heap (malloc/free), in clock cycles
+ *  - Both loops run with every interrupt masked, so neither is charged for SysTick or PendSV
+ *    (malloc is not thread safe either)
+ * Param "iterations": number of alloc/free pairs to time
+ */
+void G8RTOS_MemPoolBenchmark(uint32_t iterations)
+{
+    static MEMPOOL_BUFFER(benchBlocks, BENCH_BLOCK_SIZE, BENCH_BLOCK_COUNT);
+    static memPool_t benchPool;
+    char line[64];
+
+    if(iterations == 0)
+    {
+        return;
+    }
+
+    G8RTOS_InitMemPool(&benchPool, benchBlocks, BENCH_BLOCK_SIZE, BENCH_BLOCK_COUNT);
+
+    int32_t priMask = StartCriticalSectionAll();
+    uint32_t start = DWT->CYCCNT;
+    for(uint32_t i = 0; i < iterations; ++i)
+    {
+        G8RTOS_MemPoolFree(&benchPool, G8RTOS_MemPoolAlloc(&benchPool));
+    }
+    uint32_t poolCycles = DWT->CYCCNT - start;
+    EndCriticalSectionAll(priMask);
+
+    priMask = StartCriticalSectionAll();
+    start = DWT->CYCCNT;
+    for(uint32_t i = 0; i < iterations; ++i)
+    {
+        free(malloc(BENCH_BLOCK_SIZE));
+    }
+    uint32_t heapCycles = DWT->CYCCNT - start;
+    EndCriticalSectionAll(priMask);
+
+    snprintf(line, sizeof(line), "mempool %u B alloc+free: %u cycles", BENCH_BLOCK_SIZE, poolCycles / iterations);
+    BackChannelPrint(line, BackChannel_Info);
+    snprintf(line, sizeof(line), "malloc %u B alloc+free: %u cycles", BENCH_BLOCK_SIZE, heapCycles / iterations);
+    BackChannelPrint(line, BackChannel_Info);
+}
+
+/*********************************************** Public Functions *********************************************************************/
@@ -0,0 +1,102 @@
+/*
+ * G8RTOS_MemPool.h
+ */
+
+#ifndef G8RTOS_MEMPOOL_H_
+#define G8RTOS_MEMPOOL_H_
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+/* Words a block of a given size in bytes takes, blocks are word aligned */
+#define MEMPOOL_BLOCK_WORDS(blockSize) (((blockSize) + 3) / 4)
+
+/*
+ * Declares the storage of a pool, to pass to G8RTOS_InitMemPool
+ *  - e.g. static MEMPOOL_BUFFER(ballBlocks, sizeof(ball_t), MAXBALLS);
+ */
+#define MEMPOOL_BUFFER(name, blockSize, blockCount) uint32_t name[MEMPOOL_BLOCK_WORDS(blockSize) * (blockCount)]
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*
+ * Usage of a memory pool
+ */
+typedef struct memPoolStats_t
+{
+    uint32_t blockSize; //Holds size of each block in bytes, rounded up to whole words
+    uint32_t total; //Holds number of blocks in the pool
+    uint32_t inUse; //Holds number of blocks allocated
+    uint32_t peak; //Holds most blocks allocated at once
+    uint32_t failures; //Holds number of allocations that found the pool empty
+}memPoolStats_t;
+
+/*
+ * Memory pool typedef
+ *  - Fixed size blocks carved from a caller's buffer, free blocks are linked through their first word
+ *  - Allocating and freeing take constant time and never fragment
+ *  - A free with threads waiting hands the block straight to the head of the queue
+ */
+typedef struct memPool_t
+{
+    uint32_t *freeList; //Holds first free block
+    waitQueue_t waiters; //Holds threads waiting for a block
+    memPoolStats_t stats; //Holds usage
+}memPool_t;
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Carves a buffer into free blocks
+ * Param "pool": Pointer to memory pool
+ * Param "buffer": storage declared with MEMPOOL_BUFFER
+ * Param "blockSize": size of each block in bytes
+ * Param "blockCount": number of blocks the buffer holds
+ */
+void G8RTOS_InitMemPool(memPool_t *pool, uint32_t *buffer, uint32_t blockSize, uint32_t blockCount);
+
+/*
+ * Takes a block without blocking
+ *  - Can be called from interrupts
+ * Param "pool": Pointer to memory pool
+ * Returns: the block, 0 if the pool is empty
+ */
+void *G8RTOS_MemPoolAlloc(memPool_t *pool);
+
+/*
+ * Takes a block, blocking while the pool is empty
+ *  - Threads only
+ * Param "pool": Pointer to memory pool
+ * Param "timeout": ms to wait for, 0 to only check, WAIT_FOREVER to never time out
+ * Returns: the block, 0 if the timeout ran out
+ */
+void *G8RTOS_MemPoolAllocWait(memPool_t *pool, uint32_t timeout);
+
+/*
+ * Gives a block back to its pool
+ *  - Can be called from interrupts
+ * Param "pool": Pointer to memory pool
+ * Param "block": block taken from the same pool
+ */
+void G8RTOS_MemPoolFree(memPool_t *pool, void *block);
+
+/*
+ * Copies the usage of a memory pool
+ * Param "pool": Pointer to memory pool
+ * Param "stats": struct to fill
+ */
+void G8RTOS_GetMemPoolStats(memPool_t *pool, memPoolStats_t *stats);
+
+/*
+ * Measures allocation throughput and prints it to the back channel UART
+ *  - Times alloc/free pairs on a pool and on the C heap (malloc/free), in clock cycles
+ * Param "iterations": number of alloc/free pairs to time
+ */
+void G8RTOS_MemPoolBenchmark(uint32_t iterations);
+
+/*********************************************** Public Functions *********************************************************************/
+
+#endif /* G8RTOS_MEMPOOL_H_ */
@@ -0,0 +1,231 @@
+/*
+ * G8RTOS_MsgQueue.c
+ */
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+#include "msp.h"
+#include "G8RTOS.h"
+#include <string.h>
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+extern tcb_t * CurrentlyRunningThread;
+
+/*********************************************** Private Functions ********************************************************************/
+
+/*
+ * Initializes an empty wait queue
+ */
+static void InitWaiters(waitQueue_t *waiters)
+{
+    waiters->head = 0;
+    waiters->tail = 0;
+    waiters->order = WAIT_PRIORITY;
+    waiters->stats.waits = 0;
+    waiters->stats.blockedCycles = 0;
+}
+
+/*
+ * Copies a message into the tail slot
+ *  - Must be called inside of a critical section, with a slot free
+ */
+static void Push(msgQueue_t *queue, const void *msg)
+{
+    memcpy(&queue->buffer[queue->tail * queue->slotWords], msg, queue->msgSize);
+
+    if(++queue->tail == queue->capacity)
+    {
+        queue->tail = 0;
+    }
+
+    queue->count++;
+    if(queue->count > queue->stats.peak)
+    {
+        queue->stats.peak = queue->count;
+    }
+}
+
+/*
+ * Copies the message out of the head slot
+ *  - Must be called inside of a critical section, with a message queued
+ */
+static void Pop(msgQueue_t *queue, void *msg)
+{
+    memcpy(msg, &queue->buffer[queue->head * queue->slotWords], queue->msgSize);
+
+    if(++queue->head == queue->capacity)
+    {
+        queue->head = 0;
+    }
+
+    queue->count--;
+}
+
+/*********************************************** Private Functions ********************************************************************/
+
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Initializes an empty message queue
+ * Param "queue": Pointer to message queue
+ * Param "buffer": storage declared with MSGQUEUE_BUFFER
+ * Param "msgSize": size of each message in bytes
+ * Param "capacity": number of messages the buffer holds
+ * THIS IS A CRITICAL SECTION
+ */
+void G8RTOS_InitMsgQueue(msgQueue_t *queue, uint32_t *buffer, uint32_t msgSize, uint32_t capacity)
+{
+    int32_t priMask = StartCriticalSection();
+
+    queue->buffer = buffer;
+    queue->slotWords = MEMPOOL_BLOCK_WORDS(msgSize);
+    queue->msgSize = msgSize;
+    queue->capacity = capacity;
+    queue->count = 0;
+    queue->head = 0;
+    queue->tail = 0;
+    InitWaiters(&queue->receivers);
+    InitWaiters(&queue->senders);
+    queue->stats.sent = 0;
+    queue->stats.received = 0;
+    queue->stats.sendFailures = 0;
+    queue->stats.peak = 0;
+
+    EndCriticalSection(priMask);
+}
+
+/*
+ * Sends a message, blocking while the queue is full
+ *  - Can be called from interrupts with a timeout of 0
+ * Param "queue": Pointer to message queue
+ * Param "msg": message to copy in, msgSize bytes
+ * Param "timeout": ms to wait for, 0 to only check, WAIT_FOREVER to never time out
+ * Returns: true if the message was queued, false if the timeout ran out
+ * THIS IS A CRITICAL SECTION
+ */
+bool G8RTOS_MsgSend(msgQueue_t *queue, const void *msg, uint32_t timeout)
+{
+    int32_t priMask = StartCriticalSection();
+
+    tcb_t *receiver = queue->receivers.head;
+
+    //Receivers only wait on an empty queue, so the message goes straight to one
+    if(receiver)
+    {
+        memcpy(receiver->waitData, msg, queue->msgSize);
+        queue->stats.sent++;
+        queue->stats.received++;
+        G8RTOS_WaitQueueWakeThread(receiver);
+
+        EndCriticalSection(priMask);
+        return true;
+    }
+
+    if(queue->count < queue->capacity)
+    {
+        Push(queue, msg);
+        queue->stats.sent++;
+
+        EndCriticalSection(priMask);
+        return true;
+    }
+
+    //Queue full and caller only checks
+    if(timeout == 0)
+    {
+        queue->stats.sendFailures++;
+
+        EndCriticalSection(priMask);
+        return false;
+    }
+
+    //Blocks until a receive moves its message into the queue or the timeout runs out
+    tcb_t *thread = CurrentlyRunningThread;
+    thread->waitData = (void *)msg;
+    G8RTOS_WaitQueueInsertTimeout(&queue->senders, thread, timeout);
+
+    EndCriticalSection(priMask);
+
+    //Sets PendSV flag, to yield CPU
+    SCB->ICSR |= (1<<28);
+
+    //Runs again once woken up
+    if(thread->timedOut)
+    {
+        priMask = StartCriticalSection();
+        queue->stats.sendFailures++;
+        EndCriticalSection(priMask);
+
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Receives the oldest message, blocking while the queue is empty
+ *  - Can be called from interrupts with a timeout of 0
+ * Param "queue": Pointer to message queue
+ * Param "msg": filled with the message, msgSize bytes
+ * Param "timeout": ms to wait for, 0 to only check, WAIT_FOREVER to never time out
+ * Returns: true if a message was received, false if the timeout ran out
+ * THIS IS A CRITICAL SECTION
+ */
+bool G8RTOS_MsgReceive(msgQueue_t *queue, void *msg, uint32_t timeout)
+{
+    int32_t priMask = StartCriticalSection();
+
+    if(queue->count)
+    {
+        Pop(queue, msg);
+        queue->stats.received++;
+
+        //Slot freed, moves the message of the highest priority sender in
+        tcb_t *sender = queue->senders.head;
+        if(sender)
+        {
+            Push(queue, sender->waitData);
+            queue->stats.sent++;
+            G8RTOS_WaitQueueWakeThread(sender);
+        }
+
+        EndCriticalSection(priMask);
+        return true;
+    }
+
+    //Queue empty and caller only checks
+    if(timeout == 0)
+    {
+        EndCriticalSection(priMask);
+        return false;
+    }
+
+    //Blocks until a send copies a message straight into msg or the timeout runs out
+    tcb_t *thread = CurrentlyRunningThread;
+    thread->waitData = msg;
+    G8RTOS_WaitQueueInsertTimeout(&queue->receivers, thread, timeout);
+
+    EndCriticalSection(priMask);
+
+    //Sets PendSV flag, to yield CPU
+    SCB->ICSR |= (1<<28);
+
+    //Runs again once woken up
+    return !thread->timedOut;
+}
+
+/*
+ * Copies the usage of a message queue
+ * Param "queue": Pointer to message queue
+ * Param "stats": struct to fill
+ */
+void G8RTOS_GetMsgQueueStats(msgQueue_t *queue, msgQueueStats_t *stats)
+{
+    int32_t priMask = StartCriticalSection();
+    *stats = queue->stats;
+    EndCriticalSection(priMask);
+}
+
+/*********************************************** Public Functions *********************************************************************/
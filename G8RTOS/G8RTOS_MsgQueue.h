@@ -0,0 +1,96 @@
+/*
+ * G8RTOS_MsgQueue.h
+ */
+
+#ifndef G8RTOS_MSGQUEUE_H_
+#define G8RTOS_MSGQUEUE_H_
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+/*
+ * Declares the storage of a message queue, to pass to G8RTOS_InitMsgQueue
+ *  - Every slot is rounded up to whole words
+ *  - e.g. static MSGQUEUE_BUFFER(spawnSlots, sizeof(Point), 8);
+ */
+#define MSGQUEUE_BUFFER(name, msgSize, capacity) uint32_t name[MEMPOOL_BLOCK_WORDS(msgSize) * (capacity)]
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*
+ * Usage of a message queue
+ */
+typedef struct msgQueueStats_t
+{
+    uint32_t sent; //Holds number of messages sent
+    uint32_t received; //Holds number of messages received
+    uint32_t sendFailures; //Holds number of sends that found the queue full and gave up
+    uint32_t peak; //Holds most messages queued at once
+}msgQueueStats_t;
+
+/*
+ * Message queue typedef
+ *  - Ring of fixed size records, a whole record is copied in or out under one critical section
+ *  - To pass ownership of a buffer instead of copying it, send a pointer to a memory pool block
+ *    (msgSize sizeof(void *)), the receiver frees the block
+ *  - A send with a receiver waiting copies straight into the receiver's record
+ *  - A receive with a sender waiting moves the sender's record into the slot it freed
+ */
+typedef struct msgQueue_t
+{
+    uint32_t *buffer; //Holds slots
+    uint32_t slotWords; //Holds size of a slot in words
+    uint32_t msgSize; //Holds size of a message in bytes
+    uint32_t capacity; //Holds number of slots
+    uint32_t count; //Holds number of messages queued
+    uint32_t head; //Holds slot of the oldest message
+    uint32_t tail; //Holds next empty slot
+    waitQueue_t receivers; //Holds threads waiting for a message
+    waitQueue_t senders; //Holds threads waiting for an empty slot
+    msgQueueStats_t stats; //Holds usage
+}msgQueue_t;
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Initializes an empty message queue
+ * Param "queue": Pointer to message queue
+ * Param "buffer": storage declared with MSGQUEUE_BUFFER
+ * Param "msgSize": size of each message in bytes
+ * Param "capacity": number of messages the buffer holds
+ */
+void G8RTOS_InitMsgQueue(msgQueue_t *queue, uint32_t *buffer, uint32_t msgSize, uint32_t capacity);
+
+/*
+ * Sends a message, blocking while the queue is full
+ *  - Can be called from interrupts with a timeout of 0
+ * Param "queue": Pointer to message queue
+ * Param "msg": message to copy in, msgSize bytes
+ * Param "timeout": ms to wait for, 0 to only check, WAIT_FOREVER to never time out
+ * Returns: true if the message was queued, false if the timeout ran out
+ */
+bool G8RTOS_MsgSend(msgQueue_t *queue, const void *msg, uint32_t timeout);
+
+/*
+ * Receives the oldest message, blocking while the queue is empty
+ *  - Can be called from interrupts with a timeout of 0
+ * Param "queue": Pointer to message queue
+ * Param "msg": filled with the message, msgSize bytes
+ * Param "timeout": ms to wait for, 0 to only check, WAIT_FOREVER to never time out
+ * Returns: true if a message was received, false if the timeout ran out
+ */
+bool G8RTOS_MsgReceive(msgQueue_t *queue, void *msg, uint32_t timeout);
+
+/*
+ * Copies the usage of a message queue
+ * Param "queue": Pointer to message queue
+ * Param "stats": struct to fill
+ */
+void G8RTOS_GetMsgQueueStats(msgQueue_t *queue, msgQueueStats_t *stats);
+
+/*********************************************** Public Functions *********************************************************************/
+
+#endif /* G8RTOS_MSGQUEUE_H_ */
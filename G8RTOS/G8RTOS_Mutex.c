@@ -0,0 +1,411 @@
+/*
+ * G8RTOS_Mutex.c
+ */
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+#include "msp.h"
+#include "G8RTOS.h"
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+extern tcb_t * CurrentlyRunningThread;
+
+/*********************************************** Private Functions ********************************************************************/
+
+/*
+ * Adds a mutex to the list of mutexes a thread owns
+ */
+static void HeldPush(tcb_t *thread, mutex_t *m)
+{
+    m->nextHeld = thread->heldMutexes;
+    thread->heldMutexes = m;
+}
+
+/*
+ * Removes a mutex from the list of mutexes a thread owns
+ */
+static void HeldRemove(tcb_t *thread, mutex_t *m)
+{
+    mutex_t **link = &thread->heldMutexes;
+
+    while(*link != m)
+    {
+        link = &(*link)->nextHeld;
+    }
+
+    *link = m->nextHeld;
+}
+
+/*
+ * Finds the priority a thread is owed
+ *  - Its own priority, raised by the ceiling or highest waiter of every mutex it owns
+ */
+static uint8_t OwedPriority(tcb_t *thread)
+{
+    uint8_t priority = thread->basePriority;
+
+    for(mutex_t *m = thread->heldMutexes; m; m = m->nextHeld)
+    {
+        if((m->protocol == MUTEX_CEILING) && (m->ceiling < priority))
+        {
+            priority = m->ceiling;
+        }
+
+        //Wait queue is priority ordered, so the head is the highest waiter
+        if((m->protocol == MUTEX_INHERIT) && m->waiters.head && (m->waiters.head->priority < priority))
+        {
+            priority = m->waiters.head->priority;
+        }
+    }
+
+    return priority;
+}
+
+/*
+ * Finds the deadline an EDF thread is ordered by
+ *  - Its own job deadline, moved up to the earliest deadline of any EDF thread waiting on a MUTEX_INHERIT mutex it owns
+ *  - Every waiter is checked, EDF waiters may sit behind higher fixed priority waiters
+ *  - Fixed priority threads have no deadline, their key is returned unchanged
+ */
+static uint32_t OwedDeadline(tcb_t *thread)
+{
+    if(!thread->edfPeriod)
+    {
+        return thread->edfKey;
+    }
+
+    uint32_t deadline = thread->absDeadline;
+
+    for(mutex_t *m = thread->heldMutexes; m; m = m->nextHeld)
+    {
+        if(m->protocol != MUTEX_INHERIT)
+        {
+            continue;
+        }
+
+        for(tcb_t *waiter = m->waiters.head; waiter; waiter = waiter->waitNext)
+        {
+            if(waiter->edfPeriod && TIME_BEFORE(waiter->edfKey, deadline))
+            {
+                deadline = waiter->edfKey;
+            }
+        }
+    }
+
+    return deadline;
+}
+
+/*
+ * Makes a thread the owner of a free mutex
+ */
+static void Acquire(mutex_t *m, tcb_t *thread)
+{
+    m->owner = thread;
+    m->lockCount = 1;
+    HeldPush(thread, m);
+
+    //Owner runs at the ceiling while it holds the mutex
+    if((m->protocol == MUTEX_CEILING) && (m->ceiling < thread->priority))
+    {
+        G8RTOS_SetEffectivePriority(thread, m->ceiling);
+    }
+}
+
+/*
+ * Lends a waiter's priority to a mutex owner, and on to the owner of any mutex it is waiting for
+ *  - EDF owners also take an EDF waiter's deadline if it is earlier, all EDF threads share one priority
+ *    so without it EDF threads due between the two could keep preempting the owner
+ */
+static void InheritPriority(tcb_t *owner, tcb_t *waiter)
+{
+    while(owner)
+    {
+        bool raised = false;
+
+        if(waiter->priority < owner->priority)
+        {
+            G8RTOS_SetEffectivePriority(owner, waiter->priority);
+            raised = true;
+        }
+
+        if(waiter->edfPeriod && owner->edfPeriod && TIME_BEFORE(waiter->edfKey, owner->edfKey))
+        {
+            G8RTOS_SetEffectiveDeadline(owner, waiter->edfKey);
+            raised = true;
+        }
+
+        if(!raised)
+        {
+            break;
+        }
+
+        owner = owner->blockedMutex ? owner->blockedMutex->owner : 0;
+    }
+}
+
+/*
+ * Recomputes the priority and deadline a thread is owed, and on up the chain of owners it is blocked behind
+ *  - Used when a waiter leaves or drops its priority, so boosts inherited through the chain are given back
+ *  - Stops at the first thread whose priority and deadline do not change, nothing further up depends on anything else
+ */
+static void RecomputePriority(tcb_t *thread)
+{
+    while(thread)
+    {
+        uint8_t priority = OwedPriority(thread);
+        uint32_t deadline = OwedDeadline(thread);
+
+        if((priority == thread->priority) && (deadline == thread->edfKey))
+        {
+            break;
+        }
+
+        //Also moves it in the wait queue it is blocked in, so the next owner sees its new place
+        G8RTOS_SetEffectivePriority(thread, priority);
+        G8RTOS_SetEffectiveDeadline(thread, deadline);
+        thread = thread->blockedMutex ? thread->blockedMutex->owner : 0;
+    }
+}
+
+/*
+ * Ends a priority inversion and records how long it lasted
+ */
+static void EndInversion(mutex_t *m)
+{
+    if(m->inverted)
+    {
+        uint32_t cycles = DWT->CYCCNT - m->inversionStart;
+
+        m->stats.lastInversionCycles = cycles;
+        if(cycles > m->stats.maxInversionCycles)
+        {
+            m->stats.maxInversionCycles = cycles;
+        }
+
+        m->inverted = false;
+    }
+}
+
+/*
+ * Releases a mutex whose owner already gave it up
+ *  - Hands it to the highest priority waiter, or leaves it free
+ */
+static void Release(mutex_t *m)
+{
+    EndInversion(m);
+
+    tcb_t *next = G8RTOS_WaitQueueWake(&m->waiters);
+
+    if(next)
+    {
+        next->blockedMutex = 0;
+        Acquire(m, next);
+
+        //New owner inherits from the waiters still queued
+        RecomputePriority(next);
+    }
+    else
+    {
+        m->owner = 0;
+        m->lockCount = 0;
+    }
+}
+
+/*********************************************** Private Functions ********************************************************************/
+
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+/*
+ * Applies a change of a thread's base priority
+ *  - Recomputes the thread's priority from its base priority and the mutexes it owns
+ *  - Updates the priority every owner up the chain of mutexes it waits behind inherits, raised or lowered
+ *  - Must be called inside of a critical section
+ * Param "thread": thread whose base priority changed
+ */
+void G8RTOS_MutexPriorityChanged(tcb_t *thread)
+{
+    RecomputePriority(thread);
+}
+
+/*
+ * Cleans up the mutexes of a thread being killed
+ *  - Stops its priority from being inherited by the owners of the chain of mutexes it waited behind
+ *  - Hands every mutex it owns to the next waiter
+ *  - Must be called inside of a critical section, after the thread left its wait queue
+ * Param "thread": thread being killed
+ */
+void G8RTOS_MutexKillThread(tcb_t *thread)
+{
+    //Owners up the chain no longer inherit the killed thread's priority
+    if(thread->blockedMutex)
+    {
+        tcb_t *owner = thread->blockedMutex->owner;
+        thread->blockedMutex = 0;
+
+        RecomputePriority(owner);
+    }
+
+    //Mutexes owned by a dead thread would never be released
+    while(thread->heldMutexes)
+    {
+        mutex_t *m = thread->heldMutexes;
+        thread->heldMutexes = m->nextHeld;
+        Release(m);
+    }
+}
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Initializes a mutex as unlocked
+ * Param "m": Pointer to mutex
+ * Param "protocol": MUTEX_INHERIT or MUTEX_CEILING
+ * Param "ceiling": Priority owners run at with MUTEX_CEILING, ignored with MUTEX_INHERIT
+ * THIS IS A CRITICAL SECTION
+ */
+void G8RTOS_InitMutex(mutex_t *m, mutexProtocol_t protocol, uint8_t ceiling)
+{
+    int32_t priMask = StartCriticalSection();
+
+    m->owner = 0;
+    m->lockCount = 0;
+    m->waiters.head = 0;
+    m->waiters.tail = 0;
+    m->waiters.order = WAIT_PRIORITY;
+    m->waiters.stats.waits = 0;
+    m->waiters.stats.blockedCycles = 0;
+    m->protocol = protocol;
+    m->ceiling = ceiling;
+    m->nextHeld = 0;
+    m->inverted = false;
+    m->inversionStart = 0;
+    m->stats.inversions = 0;
+    m->stats.lastInversionCycles = 0;
+    m->stats.maxInversionCycles = 0;
+
+    EndCriticalSection(priMask);
+}
+
+/*
+ * Locks a mutex
+ *  - Takes it if it is free or already owned by the current thread
+ *  - Otherwise blocks, lending the current thread's priority to the owner with MUTEX_INHERIT
+ * Param "m": Pointer to mutex
+ * THIS IS A CRITICAL SECTION
+ */
+void G8RTOS_LockMutex(mutex_t *m)
+{
+    int32_t priMask = StartCriticalSection();
+
+    tcb_t *thread = CurrentlyRunningThread;
+
+    //Free mutex is taken right away
+    if(!m->owner)
+    {
+        Acquire(m, thread);
+        EndCriticalSection(priMask);
+        return;
+    }
+
+    //Owner locking again only counts the lock
+    if(m->owner == thread)
+    {
+        m->lockCount++;
+        EndCriticalSection(priMask);
+        return;
+    }
+
+    //Waiting on a lower priority owner, or an EDF owner due later, is a priority inversion
+    bool inversion = (thread->priority < m->owner->priority) ||
+                     ((thread->priority == m->owner->priority) && thread->edfPeriod && m->owner->edfPeriod &&
+                      TIME_BEFORE(thread->edfKey, m->owner->edfKey));
+    if(inversion && !m->inverted)
+    {
+        m->inverted = true;
+        m->inversionStart = DWT->CYCCNT;
+        m->stats.inversions++;
+    }
+
+    //Owner runs at the waiter's priority so medium priority threads cannot hold it up
+    if(m->protocol == MUTEX_INHERIT)
+    {
+        InheritPriority(m->owner, thread);
+    }
+
+    //Blocks until the owner hands the mutex over
+    thread->blockedMutex = m;
+    G8RTOS_WaitQueueInsert(&m->waiters, thread);
+
+    EndCriticalSection(priMask);
+
+    //Sets PendSV flag, to yield CPU
+    SCB->ICSR |= (1<<28);
+}
+
+/*
+ * Unlocks a mutex
+ *  - Mutex is released once it has been unlocked as many times as it was locked
+ *  - On release, the owner drops back to its own priority and the highest priority waiter gets the mutex
+ * Param "m": Pointer to mutex
+ * Returns: MUTEX_NOT_OWNER if the current thread does not own the mutex
+ * THIS IS A CRITICAL SECTION
+ */
+sched_ErrCode_t G8RTOS_UnlockMutex(mutex_t *m)
+{
+    int32_t priMask = StartCriticalSection();
+
+    tcb_t *thread = CurrentlyRunningThread;
+
+    if(m->owner != thread)
+    {
+        EndCriticalSection(priMask);
+        return MUTEX_NOT_OWNER;
+    }
+
+    //Still locked by an outer lock of the same thread
+    if(--m->lockCount)
+    {
+        EndCriticalSection(priMask);
+        return NO_ERROR;
+    }
+
+    //Gives mutex to the next waiter
+    HeldRemove(thread, m);
+    Release(m);
+
+    //Drops back to the priority and deadline owed by the mutexes still owned
+    uint8_t priority = OwedPriority(thread);
+    uint32_t deadline = OwedDeadline(thread);
+    bool lowered = (priority > thread->priority) || (deadline != thread->edfKey);
+    G8RTOS_SetEffectivePriority(thread, priority);
+    G8RTOS_SetEffectiveDeadline(thread, deadline);
+
+    EndCriticalSection(priMask);
+
+    //A higher priority thread may be ready now
+    if(lowered)
+    {
+        SCB->ICSR |= (1<<28);
+    }
+
+    return NO_ERROR;
+}
+
+/*
+ * Copies the priority inversion statistics of a mutex
+ * Param "m": Pointer to mutex
+ * Param "stats": struct to fill
+ */
+void G8RTOS_GetMutexStats(mutex_t *m, mutexStats_t *stats)
+{
+    int32_t priMask = StartCriticalSection();
+    *stats = m->stats;
+    EndCriticalSection(priMask);
+}
+
+/*********************************************** Public Functions *********************************************************************/
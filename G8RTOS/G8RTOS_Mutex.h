@@ -0,0 +1,92 @@
+/*
+ * G8RTOS_Mutex.h
+ */
+
+#ifndef G8RTOS_MUTEX_H_
+#define G8RTOS_MUTEX_H_
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*
+ * How a mutex avoids unbounded priority inversion
+ *  - MUTEX_INHERIT: the owner runs at the priority of its highest priority waiter, an EDF owner is also
+ *                   ordered by the earliest deadline of its EDF waiters
+ *  - MUTEX_CEILING: the owner runs at the mutex's ceiling priority while it holds it
+ */
+typedef enum
+{
+    MUTEX_INHERIT = 0,
+    MUTEX_CEILING = 1
+}mutexProtocol_t;
+
+/*
+ * Priority inversion statistics, times are in clock cycles
+ *  - An inversion starts when a thread waits on a mutex owned by a lower priority thread
+ *  - It ends when the owner releases the mutex
+ */
+typedef struct mutexStats_t
+{
+    uint32_t inversions; //Holds number of priority inversions
+    uint32_t lastInversionCycles; //Holds length of the last inversion
+    uint32_t maxInversionCycles; //Holds length of the longest inversion
+}mutexStats_t;
+
+/*
+ * Mutex typedef
+ *  - Owned by one thread at a time, the owner may lock it again (recursive)
+ *  - Waiting threads wake up in priority order (EDF threads by deadline) and the mutex is handed straight to them
+ */
+typedef struct mutex_t
+{
+    struct tcb_t *owner; //Holds owning thread, 0 when free
+    uint32_t lockCount; //Holds number of times the owner locked it
+    waitQueue_t waiters; //Holds threads waiting for the mutex
+    mutexProtocol_t protocol; //Holds inversion protocol
+    uint8_t ceiling; //Holds ceiling priority for MUTEX_CEILING
+    struct mutex_t *nextHeld; //Holds next mutex owned by the same thread
+    bool inverted; //True while a higher priority thread waits on the owner
+    uint32_t inversionStart; //Holds cycle count when the current inversion started
+    mutexStats_t stats; //Holds inversion statistics
+}mutex_t;
+
+/*********************************************** Datatype Definitions *****************************************************************/
+mutex_t sensorMutex; //Mutex used for sensor communication
+mutex_t LCDMutex; //Mutex used for LCD communication
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Initializes a mutex as unlocked
+ * Param "m": Pointer to mutex
+ * Param "protocol": MUTEX_INHERIT or MUTEX_CEILING
+ * Param "ceiling": Priority owners run at with MUTEX_CEILING, ignored with MUTEX_INHERIT
+ */
+void G8RTOS_InitMutex(mutex_t *m, mutexProtocol_t protocol, uint8_t ceiling);
+
+/*
+ * Locks a mutex
+ *  - Takes it if it is free or already owned by the current thread
+ *  - Otherwise blocks, lending the current thread's priority to the owner with MUTEX_INHERIT
+ * Param "m": Pointer to mutex
+ */
+void G8RTOS_LockMutex(mutex_t *m);
+
+/*
+ * Unlocks a mutex
+ *  - Mutex is released once it has been unlocked as many times as it was locked
+ *  - On release, the owner drops back to its own priority and the highest priority waiter gets the mutex
+ * Param "m": Pointer to mutex
+ * Returns: MUTEX_NOT_OWNER if the current thread does not own the mutex
+ */
+sched_ErrCode_t G8RTOS_UnlockMutex(mutex_t *m);
+
+/*
+ * Copies the priority inversion statistics of a mutex
+ * Param "m": Pointer to mutex
+ * Param "stats": struct to fill
+ */
+void G8RTOS_GetMutexStats(mutex_t *m, mutexStats_t *stats);
+
+/*********************************************** Public Functions *********************************************************************/
+
+#endif /* G8RTOS_MUTEX_H_ */
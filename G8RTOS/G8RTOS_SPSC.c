@@ -0,0 +1,187 @@
+/*
+ * G8RTOS_SPSC.c
+ */
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+#include "msp.h"
+#include "BSP.h"
+#include "G8RTOS.h"
+#include <stdio.h>
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+/*********************************************** Defines ******************************************************************************/
+
+/* Words in the ring used by G8RTOS_SPSCBenchmark */
+#define BENCH_RING_SIZE 16
+
+/*********************************************** Defines ******************************************************************************/
+
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Initializes an empty ring
+ * Param "ring": Pointer to ring
+ * Param "buffer": storage for the words
+ * Param "size": number of words in buffer, must be a power of two
+ * Param "wakeGroup": event group to wake the consumer through, 0 for none
+ * Param "wakeEvent": flag set in wakeGroup
+ * Returns: false if size is not a power of two
+ */
+bool G8RTOS_InitSPSC(spscRing_t *ring, int32_t *buffer, uint32_t size, eventGroup_t *wakeGroup, uint32_t wakeEvent)
+{
+    if((size == 0) || (size & (size - 1)))
+    {
+        return false;
+    }
+
+    ring->buffer = buffer;
+    ring->mask = size - 1;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->dropped = 0;
+    ring->wakeGroup = wakeGroup;
+    ring->wakeEvent = wakeEvent;
+
+    return true;
+}
+
+/*
+ * Pushes a word, producer only
+ *  - Can be called from interrupts
+ * Param "ring": Pointer to ring
+ * Param "data": word to push
+ * Returns: false if the ring was full and the word was dropped
+ */
+bool G8RTOS_SPSCPush(spscRing_t *ring, int32_t data)
+{
+    uint32_t tail = ring->tail;
+    uint32_t head = ring->head;
+
+    if((tail - head) > ring->mask)
+    {
+        ring->dropped++;
+        return false;
+    }
+
+    ring->buffer[tail & ring->mask] = data;
+
+    //Word must be written before the consumer can see the new tail
+    __DMB();
+    ring->tail = tail + 1;
+
+    //Consumer only blocks once it emptied the ring, so only a word pushed onto an empty ring wakes it
+    //Head is read again since the consumer may have emptied the ring while this word was written
+    if(ring->wakeGroup && (ring->head == tail))
+    {
+        G8RTOS_SetEvents(ring->wakeGroup, ring->wakeEvent);
+    }
+
+    return true;
+}
+
+/*
+ * Pops the oldest word without blocking, consumer only
+ * Param "ring": Pointer to ring
+ * Param "data": filled with the word
+ * Returns: false if the ring was empty
+ */
+bool G8RTOS_SPSCPop(spscRing_t *ring, int32_t *data)
+{
+    uint32_t head = ring->head;
+
+    if(ring->tail == head)
+    {
+        return false;
+    }
+
+    //Word must be read after the tail that published it
+    __DMB();
+    *data = ring->buffer[head & ring->mask];
+
+    //Word must be read before the producer can reuse its slot
+    __DMB();
+    ring->head = head + 1;
+
+    return true;
+}
+
+/*
+ * Pops the oldest word, blocking on the wake event while the ring is empty
+ *  - Consumer thread only, rings without a wake group never block
+ *  - A flag left set by a word already popped ends one wait early, the ring is checked again after every wait
+ * Param "ring": Pointer to ring
+ * Param "data": filled with the word
+ * Param "timeout": ms to wait for, 0 to only check, WAIT_FOREVER to never time out
+ * Returns: false if the timeout ran out
+ */
+bool G8RTOS_SPSCPopWait(spscRing_t *ring, int32_t *data, uint32_t timeout)
+{
+    while(!G8RTOS_SPSCPop(ring, data))
+    {
+        if(!ring->wakeGroup || (timeout == 0) ||
+           !G8RTOS_WaitEvents(ring->wakeGroup, ring->wakeEvent, EVENT_WAIT_ANY | EVENT_CLEAR_ON_EXIT, timeout))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Returns the number of words in the ring
+ * Param "ring": Pointer to ring
+ */
+uint32_t G8RTOS_SPSCCount(spscRing_t *ring)
+{
+    return ring->tail - ring->head;
+}
+
+/*
+ * Measures push/pop cost and prints it to the back channel UART
+ *  - Times push/pop pairs on a ring and writeFIFO/readFIFO pairs on the last FIFO, in clock cycles
+ *  - Reinitializes FIFO MAX_NUMBER_OF_FIFOS - 1, call it from a thread
+ * Param "iterations": number of pairs to time
+ */
+void G8RTOS_SPSCBenchmark(uint32_t iterations)
+{
+    static int32_t benchBuffer[BENCH_RING_SIZE];
+    static spscRing_t benchRing;
+    uint32_t fifo = MAX_NUMBER_OF_FIFOS - 1;
+    int32_t data;
+    char line[64];
+
+    if(iterations == 0)
+    {
+        return;
+    }
+
+    G8RTOS_InitSPSC(&benchRing, benchBuffer, BENCH_RING_SIZE, 0, 0);
+    G8RTOS_InitFIFO(fifo);
+
+    uint32_t start = DWT->CYCCNT;
+    for(uint32_t i = 0; i < iterations; ++i)
+    {
+        G8RTOS_SPSCPush(&benchRing, i);
+        G8RTOS_SPSCPop(&benchRing, &data);
+    }
+    uint32_t ringCycles = DWT->CYCCNT - start;
+
+    start = DWT->CYCCNT;
+    for(uint32_t i = 0; i < iterations; ++i)
+    {
+        writeFIFO(fifo, i);
+        readFIFO(fifo);
+    }
+    uint32_t fifoCycles = DWT->CYCCNT - start;
+
+    snprintf(line, sizeof(line), "spsc push+pop: %u cycles", ringCycles / iterations);
+    BackChannelPrint(line, BackChannel_Info);
+    snprintf(line, sizeof(line), "fifo write+read: %u cycles", fifoCycles / iterations);
+    BackChannelPrint(line, BackChannel_Info);
+}
+
+/*********************************************** Public Functions *********************************************************************/
@@ -0,0 +1,86 @@
+/*
+ * G8RTOS_SPSC.h
+ */
+
+#ifndef G8RTOS_SPSC_H_
+#define G8RTOS_SPSC_H_
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*
+ * Single producer, single consumer ring typedef
+ *  - Only the producer writes tail and dropped, only the consumer writes head
+ *  - Indexes run freely and wrap through the mask, so tail - head is the count even across 2^32
+ *  - Push and pop are wait-free and take no critical section, so an ISR can be the producer
+ *  - Optionally sets an event flag when a push makes the ring non-empty, to wake a blocked consumer
+ */
+typedef struct spscRing_t
+{
+    int32_t *buffer; //Holds slots
+    uint32_t mask; //Holds number of slots - 1, slots are a power of two
+    volatile uint32_t head; //Holds count of words popped, written by the consumer
+    volatile uint32_t tail; //Holds count of words pushed, written by the producer
+    uint32_t dropped; //Holds number of pushes that found the ring full
+    eventGroup_t *wakeGroup; //Holds event group the consumer waits on, 0 for no wakeup
+    uint32_t wakeEvent; //Holds flag set in wakeGroup
+}spscRing_t;
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Initializes an empty ring
+ * Param "ring": Pointer to ring
+ * Param "buffer": storage for the words
+ * Param "size": number of words in buffer, must be a power of two
+ * Param "wakeGroup": event group to wake the consumer through, 0 for none
+ * Param "wakeEvent": flag set in wakeGroup
+ * Returns: false if size is not a power of two
+ */
+bool G8RTOS_InitSPSC(spscRing_t *ring, int32_t *buffer, uint32_t size, eventGroup_t *wakeGroup, uint32_t wakeEvent);
+
+/*
+ * Pushes a word, producer only
+ *  - Can be called from interrupts
+ * Param "ring": Pointer to ring
+ * Param "data": word to push
+ * Returns: false if the ring was full and the word was dropped
+ */
+bool G8RTOS_SPSCPush(spscRing_t *ring, int32_t data);
+
+/*
+ * Pops the oldest word without blocking, consumer only
+ * Param "ring": Pointer to ring
+ * Param "data": filled with the word
+ * Returns: false if the ring was empty
+ */
+bool G8RTOS_SPSCPop(spscRing_t *ring, int32_t *data);
+
+/*
+ * Pops the oldest word, blocking on the wake event while the ring is empty
+ *  - Consumer thread only, rings without a wake group never block
+ * Param "ring": Pointer to ring
+ * Param "data": filled with the word
+ * Param "timeout": ms to wait for, 0 to only check, WAIT_FOREVER to never time out
+ * Returns: false if the timeout ran out
+ */
+bool G8RTOS_SPSCPopWait(spscRing_t *ring, int32_t *data, uint32_t timeout);
+
+/*
+ * Returns the number of words in the ring
+ * Param "ring": Pointer to ring
+ */
+uint32_t G8RTOS_SPSCCount(spscRing_t *ring);
+
+/*
+ * Measures push/pop cost and prints it to the back channel UART
+ *  - Times push/pop pairs on a ring and writeFIFO/readFIFO pairs on the last FIFO, in clock cycles
+ *  - Reinitializes FIFO MAX_NUMBER_OF_FIFOS - 1, call it from a thread
+ * Param "iterations": number of pairs to time
+ */
+void G8RTOS_SPSCBenchmark(uint32_t iterations);
+
+/*********************************************** Public Functions *********************************************************************/
+
+#endif /* G8RTOS_SPSC_H_ */
@@ -31,6 +31,13 @@ extern tcb_t *CurrentlyRunningThread;
 /* Status Register with the Thumb-bit Set */
 #define THUMBBIT 0x01000000
 
+/* Thread IDs hold the handle table index in the low byte and the slot's generation above it */
+#define THREAD_INDEX_MASK 0xFF
+#define THREAD_GENERATION_SHIFT 8
+
+/* EXC_RETURN a new thread starts with: thread mode, main stack, no FPU state */
+#define EXC_RETURN_THREAD_BASIC 0xFFFFFFF9
+
 /*********************************************** Defines ******************************************************************************/
 
 
@@ -41,16 +48,68 @@ extern tcb_t *CurrentlyRunningThread;
  */
 static tcb_t threadControlBlocks[MAX_THREADS];
 
-/* Thread Stacks
- *	- An array of arrays that will act as individual stacks for each thread
- */
-static int32_t threadStacks[MAX_THREADS][STACKSIZE];
-
 /* Periodic Event Threads
  * - An array of periodic events to hold pertinent information for each thread
  */
 static ptcb_t Pthread[MAXPTHREADS];
 
+/* Periodic Event Heap
+ *  - Min-heap of periodic events keyed by execute time
+ *  - PthreadHeap[0] is always the next event to run
+ */
+static ptcb_t *PthreadHeap[MAXPTHREADS];
+
+#if G8RTOS_DEFERRED_PERIODIC
+/* Due Periodic Events
+ *  - Circular queue of periodic events waiting for the worker thread
+ *  - An event is queued once when its pending count goes from 0 to 1, so it never overflows
+ *  - periodicDue counts queued events
+ */
+static ptcb_t *dueQueue[MAXPTHREADS];
+static uint32_t dueHead;
+static uint32_t dueCount;
+static semaphore_t periodicDue;
+#endif
+
+/* Ready Lists
+ *  - One circular list of ready threads per priority level
+ *  - The head of each list is the next thread of that priority to run
+ */
+static tcb_t *readyList[MAX_PRIORITIES];
+
+/* Ready Bitmap
+ *  - One bit per priority level, set while that level's ready list is not empty
+ *  - Bits are stored MSB first so count leading zeros returns the highest priority (lowest number)
+ *  - readyGroup holds one bit per word of readyBitmap that is not zero
+ */
+static uint32_t readyBitmap[MAX_PRIORITIES / 32];
+static uint32_t readyGroup;
+
+/* Time Slices
+ *  - Ticks the head of each priority's ready list runs before the list rotates
+ */
+static uint8_t sliceTicks[MAX_PRIORITIES];
+
+/* Sleep Queue
+ *  - Sleeping threads sorted by wake up time (delta list)
+ *  - Each thread's sleepDelta is counted from the wake up time of the thread ahead of it
+ *  - Only the head has to be touched every tick
+ */
+static tcb_t *sleepQueue;
+
+/* Idle Statistics
+ *  - Counted since last read of the statistics
+ */
+static idleStats_t idleStats;
+
+/* Context Switch Statistics
+ *  - Indexed by switchKind_t, written by PendSV_Handler
+ */
+switchStats_t contextSwitchStats[NUMBER_OF_SWITCH_KINDS];
+
+/* Cycles taken by the last switch of any kind, written by PendSV_Handler */
+uint32_t lastPendSVCycles;
+
 /*********************************************** Data Structures Used *****************************************************************/
 
 
@@ -67,9 +126,65 @@ static uint32_t NumberOfThreads;
 static uint32_t NumberOfPthreads;
 
 /*
- * ID for thread
+ * Free slots of the thread handle table, used as a stack
+ */
+static uint8_t freeSlots[MAX_THREADS];
+static uint32_t freeSlotCount;
+
+/*
+ * Thread that killed itself, its stack and slot are freed once its context has been saved
+ */
+static tcb_t *pendingReap;
+
+/*
+ * Number of clock cycles in one 1ms tick
+ */
+static uint32_t cyclesPerTick;
+
+/*
+ * Most clock cycles taken by one SysTick_Handler
+ */
+static uint32_t tickMaxCycles;
+
+/*
+ * Cycle count at the last context switch, the running thread is charged for cycles since then
  */
-static uint16_t IDCounter;
+static uint32_t lastSwitchCycles;
+
+/*
+ * Cycle count at the last G8RTOS_PrintThreadStats
+ */
+static uint32_t lastReportCycles;
+
+/*
+ * Thread that calls G8RTOS_Idle, its share of the CPU is the idle percent
+ */
+static tcb_t *idleThread;
+
+#if G8RTOS_TICKLESS
+/*
+ * Longest the tick can be stopped for, limited by the 24-bit SysTick reload register
+ */
+static uint32_t maxIdleTicks;
+#endif
+
+#if G8RTOS_SCHED_BENCHMARK
+/*
+ * Synthetic threads G8RTOS_SchedulerBenchmark schedules, they are never run
+ */
+static tcb_t benchThreads[SCHED_BENCH_MAX_THREADS];
+
+/*
+ * Real ready lists, kept while the benchmark uses the ready lists
+ */
+static tcb_t *benchSavedList[MAX_PRIORITIES];
+static uint32_t benchSavedBitmap[MAX_PRIORITIES / 32];
+
+/*
+ * SystemTime every G8RTOS_SleepBenchmark thread wakes up at
+ */
+static uint32_t benchWakeTime;
+#endif
 /*********************************************** Private Variables ********************************************************************/
 
 
@@ -86,519 +201,2341 @@ static void InitSysTick(uint32_t numCycles)
 }
 
 
-void G8RTOS_Scheduler()
+/*
+ * Frees the stack and handle table slot of a dead thread
+ * Param "thread": killed thread whose stack is no longer in use
+ */
+static void ReapThread(tcb_t *thread)
 {
-    //Prospective thread and setting lowest priority
-    tcb_t *tempNextThread = CurrentlyRunningThread->next;
-    uint16_t currentMaxPriority = 256;
+    G8RTOS_StackFree(thread->stackBase, thread->stackSize);
 
-    //Iterates through all threads
-    for(uint8_t i = 0; i < NumberOfThreads; ++i)
-    {
-        //If currently running thread is not blocked AND not asleep, then
-        if((!tempNextThread->blocked) && (!tempNextThread->asleep))
-        {
-            //If possible next thread has a higher priority than highest priority
-            if(tempNextThread->priority < currentMaxPriority)
-            {
-                CurrentlyRunningThread = tempNextThread;
-                currentMaxPriority = CurrentlyRunningThread->priority;
-            }
-        }
-        //Switches possible next thread to next
-        tempNextThread = tempNextThread->next;
-    }
+    //Slot can be reused, its generation changes when it is
+    freeSlots[freeSlotCount++] = thread - threadControlBlocks;
 }
 
-
 /*
- * SysTick Handler
- * The Systick Handler now will increment the system time,
- * set the PendSV flag to start the scheduler,
- * and be responsible for handling sleeping and periodic threads
+ * Chooses the next thread to run
+ *  - Finds the highest ready priority from the ready bitmap with two count leading zeros
+ *  - Runs the head of that priority's ready list, the head only moves on when its time slice runs out (round robin)
+ * Runs in constant time no matter how many threads exist
  */
-void SysTick_Handler()
+void G8RTOS_Scheduler()
 {
-    //Increments system time
-    SystemTime++;
-
-    //Checks periodic threads to see if they are to be dealt with
-    for(uint8_t i = 0; i < NumberOfPthreads; ++i)
+    //Charges the thread being switched out for the cycles it ran
+    uint32_t now = DWT->CYCCNT;
+    tcb_t *previous = CurrentlyRunningThread;
+    if(previous)
     {
-        //If execute time is equal to system time
-        if(Pthread[i].executeTime == SystemTime)
-        {
-            //Defines new execute time to be "period" ms from now
-            Pthread[i].executeTime = Pthread[i].period + SystemTime + Pthread[i].currentTime;
+        previous->runCycles += now - lastSwitchCycles;
+    }
+    lastSwitchCycles = now;
 
-            //Runs Periodic thread
-            (*(Pthread[i].Handler))();
-        }
+    //PendSV_Handler finishes timing a switch after the scheduler returns, so the previous switch is recorded
+    if(previous)
+    {
+        G8RTOS_PROBE_SAMPLE(PROBE_PENDSV, lastPendSVCycles);
     }
 
-    //Wakes up threads that need to be woken up
-    tcb_t *temp = CurrentlyRunningThread;
-    for(uint8_t i = 0; i < NumberOfThreads; ++i)
+    //If nothing is ready, keep running the current thread
+    if(!readyGroup)
     {
-        //If thread is asleep
-        if(temp->asleep)
-        {
-            //If thread reaches wake up time, then wake it up threadControlBlocks[i].sleepCount == SystemTime
-            if(temp->sleepCount <= SystemTime)
-            {
-                //Thread woken up and sleep count made 0
-                temp->asleep = false;
-                temp->sleepCount = 0;
-            }
-        }
-        //Points to the next thread
-        temp = temp->next;
+        return;
     }
 
-    //Sets PendSV flag
-    SCB->ICSR |= (1<<28);
-}
+    //Finds highest priority with a ready thread
+    uint32_t group = __CLZ(readyGroup);
+    uint32_t priority = (group << 5) | __CLZ(readyBitmap[group]);
 
-/*
- * Finds the current time for a periodic thread to not have muliples of periods
- */
-static uint32_t findCurrTime(uint32_t period)
-{
-    //If first thread being added
-    if(NumberOfPthreads == 0)
+    //Runs head of list, SysTick rotates the list once its slice runs out
+    CurrentlyRunningThread = readyList[priority];
+
+    if(CurrentlyRunningThread != previous)
     {
-        return 0;
+        CurrentlyRunningThread->switchesIn++;
+        G8RTOS_TRACE_EVENT(TRACE_SWITCH, CurrentlyRunningThread, previous ? (previous->threadID & THREAD_INDEX_MASK) : TRACE_NO_THREAD);
     }
-    uint32_t curr = 0;
-    int i;
-    for(i = 0; i < NumberOfPthreads; ++i)
+
+    //Context of a thread that killed itself was saved on its stack, so the stack is no longer used
+    if(pendingReap)
     {
-        if(((Pthread[i].period % period) == 0 ) || ((period % Pthread[i].period) == 0))
-        {
-            return 1;
-        }
+        ReapThread(pendingReap);
+        pendingReap = 0;
     }
-    return curr;
 }
-/*********************************************** Private Functions ********************************************************************/
 
 
-/*********************************************** Public Variables *********************************************************************/
+/*
+ * Moves a periodic event up the heap while it runs before its parent
+ * Param "index": heap index of the event
+ */
+static void HeapSiftUp(uint32_t index)
+{
+    ptcb_t *event = PthreadHeap[index];
 
-/* Holds the current time for the whole System */
-uint32_t SystemTime;
+    while(index > 0)
+    {
+        uint32_t parent = (index - 1) >> 1;
 
-/*********************************************** Public Variables *********************************************************************/
+        //Stops once parent runs first
+        if(!TIME_BEFORE(event->executeTime, PthreadHeap[parent]->executeTime))
+        {
+            break;
+        }
 
+        PthreadHeap[index] = PthreadHeap[parent];
+        index = parent;
+    }
 
-/*********************************************** Public Functions *********************************************************************/
+    PthreadHeap[index] = event;
+}
 
 /*
- * Sets variables to an initial state (system time and number of threads)
- * Enables board for highest speed clock and disables watchdog
+ * Moves a periodic event down the heap while a child runs before it
+ * Param "index": heap index of the event
  */
-void G8RTOS_Init()
+static void HeapSiftDown(uint32_t index)
 {
-    //Sets system time to 0
-    SystemTime = 0;
+    ptcb_t *event = PthreadHeap[index];
 
-    //Sets number of threads to 0
-    NumberOfThreads = 0;
+    while(1)
+    {
+        uint32_t child = (index << 1) + 1;
 
-    //Sets number of periodic threads to 0
-    NumberOfPthreads = 0;
+        if(child >= NumberOfPthreads)
+        {
+            break;
+        }
 
-    //Sets ID to 0
-    IDCounter = 0;
+        //Picks the child that runs first
+        if((child + 1 < NumberOfPthreads) &&
+           TIME_BEFORE(PthreadHeap[child + 1]->executeTime, PthreadHeap[child]->executeTime))
+        {
+            child++;
+        }
 
-    //Initializes board
-    BSP_InitBoard();
+        //Stops once event runs before both children
+        if(!TIME_BEFORE(PthreadHeap[child]->executeTime, event->executeTime))
+        {
+            break;
+        }
 
-    //Relocates the ISR interrupt vector table to 0x20000000
-    uint32_t newVTORTable = 0x20000000;
-    memcpy((uint32_t *)newVTORTable, (uint32_t *)SCB->VTOR, 57*4); // 57 interrupt vectors to copy
-    SCB->VTOR = newVTORTable;
+        PthreadHeap[index] = PthreadHeap[child];
+        index = child;
+    }
+
+    PthreadHeap[index] = event;
 }
 
 /*
- * Starts G8RTOS Scheduler
- * 	- Initializes the Systick
- * 	- Sets Context to thread with highest priority
- * Returns: Error Code for starting scheduler. This will only return if the scheduler fails
+ * Updates lateness and jitter statistics of a periodic event about to run
+ * Param "event": event being released
+ * Param "lateness": ms since its release time
  */
-int G8RTOS_Launch()
+static void PeriodicRecordLateness(ptcb_t *event, uint32_t lateness)
 {
-    //Sets currently running thread to first tcb
-    CurrentlyRunningThread = &threadControlBlocks[0];
+    uint32_t jitter = (lateness > event->stats.lastLateness) ?
+                      (lateness - event->stats.lastLateness) : (event->stats.lastLateness - lateness);
 
-    //Makes currently running thread to thread with highest priority
-    for(uint32_t i = 1; i < NumberOfThreads; ++i)
+    if(event->stats.releases && (jitter > event->stats.maxJitter))
     {
-        if(threadControlBlocks[i].priority < CurrentlyRunningThread->priority)
-        {
-            CurrentlyRunningThread = &threadControlBlocks[i];
-        }
+        event->stats.maxJitter = jitter;
     }
 
-    //Gets clock frequency
-    uint32_t clkFreq = ClockSys_GetSysFreq();
-
-    //Initializes SysTick
-    InitSysTick((clkFreq/1000));
-
-    //Sets priorities for PENDSV and SysTick
-    NVIC_SetPriority(PendSV_IRQn, 7);
-
-    //Call G8RTOS_Start
-    G8RTOS_Start();
+    if(lateness > event->stats.maxLateness)
+    {
+        event->stats.maxLateness = lateness;
+    }
 
-    return ERROR;
+    event->stats.lastLateness = lateness;
+    event->stats.releases++;
 }
 
 /*
- * Funtion that finds the closest left index
- * param: current index
- * return: closest left index
+ * Moves a periodic event's execute time to its next release
+ *  - PERIODIC_CATCH_UP: one period, so missed releases run on the following passes
+ *  - PERIODIC_SKIP: first release after the current time, missed releases are counted
+ * Param "event": event that was just released
  */
-static uint32_t findLeftNode(uint16_t index)
+static void PeriodicAdvance(ptcb_t *event)
 {
-    for(uint32_t i = index - 1; i <= MAX_THREADS - 1; --i)
+    if(event->policy == PERIODIC_SKIP)
     {
-        //Looks for left neighbor
-        if(threadControlBlocks[i].isAlive)
-        {
-            return i;
-        }
-
-        //If index 0, point to rightmost index
-        if(!i)
-        {
-            i = MAX_THREADS;
-        }
+        uint32_t missed = (SystemTime - event->executeTime) / event->period;
+        event->stats.skipped += missed;
+        event->executeTime += (missed + 1) * event->period;
+    }
+    else
+    {
+        event->executeTime += event->period;
     }
-    return MAX_THREADS + 1;
 }
 
+#if G8RTOS_DEFERRED_PERIODIC
 /*
- * Funtion that finds the closest right index
- * param: current index
- * return: closest right index
+ * Hands a released periodic event to the worker thread
+ *  - Queues the event if it is not already waiting
+ *  - A waiting PERIODIC_CATCH_UP event runs once more, a waiting PERIODIC_SKIP event drops the release
+ * Param "event": event being released
  */
-static uint32_t findRightNode(uint16_t index)
+static void PeriodicMarkDue(ptcb_t *event)
 {
-    //If index is last and index 0 is alive, return 0
-    if(index == 22)
+    if(event->pending == 0)
     {
-        if(threadControlBlocks[0].isAlive)
-        {
-            return 0;
-        }
-        index = 0;
+        event->pending = 1;
+        event->releaseTime = event->executeTime;
+
+        dueQueue[(dueHead + dueCount) % MAXPTHREADS] = event;
+        dueCount++;
+        G8RTOS_SignalSemaphore(&periodicDue);
     }
+    else if(event->policy == PERIODIC_CATCH_UP)
+    {
+        event->pending++;
+    }
+    else
+    {
+        event->stats.skipped++;
+    }
+}
 
-    for(uint32_t i = index + 1; i <= MAX_THREADS - 1; ++i)
+/*
+ * Periodic event worker thread
+ *  - Waits for SysTick to release periodic events
+ *  - Runs each released handler once per pending release, outside of interrupt context
+ */
+static void PeriodicWorker(void)
+{
+    while(1)
     {
-        //Looks for right neighbor
-        if(threadControlBlocks[i].isAlive)
-        {
-            return i;
-        }
+        //Waits for a due event
+        G8RTOS_WaitSemaphore(&periodicDue);
+
+        int32_t priMask = StartCriticalSection();
 
-        //If index 0, point to leftmost index
-        if(i == MAX_THREADS - 1)
+        ptcb_t *event = dueQueue[dueHead];
+        dueHead = (dueHead + 1) % MAXPTHREADS;
+        dueCount--;
+
+        do
         {
-            //Looks for right neighbor
-            if(threadControlBlocks[0].isAlive)
-            {
-                return 0;
-            }
-            i = 0;
-        }
+            //Lateness includes the time spent waiting for the worker
+            PeriodicRecordLateness(event, SystemTime - event->releaseTime);
+            EndCriticalSection(priMask);
+
+            //Runs Periodic thread
+            (*(event->Handler))();
+
+            priMask = StartCriticalSection();
+            event->releaseTime += event->period;
+        } while(--event->pending);
+
+        EndCriticalSection(priMask);
     }
-    return MAX_THREADS + 1;
 }
-
+#endif
 
 /*
- * Adds threads to G8RTOS Scheduler
- * 	- Checks if there are stil available threads to insert to scheduler
- * 	- Initializes the thread control block for the provided thread
- * 	- Initializes the stack for the provided thread to hold a "fake context"
- * 	- Sets stack tcb stack pointer to top of thread stack
- * 	- Sets up the next and previous tcb pointers in a round robin fashion
- * Param "threadToAdd": Void-Void Function to add as preemptable main thread
- * Param "priority": specified priority of new thread
- * Param "name": Name given to thread
- * Returns: Error code for adding threads
+ * SysTick Handler
+ * The Systick Handler now will increment the system time,
+ * set the PendSV flag to start the scheduler,
+ * and be responsible for handling sleeping and periodic threads
  */
-int G8RTOS_AddThread(void (*threadToAdd)(void), uint8_t priority, char* name)
+void SysTick_Handler()
 {
-    int32_t priMask = StartCriticalSection();
+    //Cycle count at entry, to track the handler's worst case duration
+    uint32_t startCycles = DWT->CYCCNT;
+    G8RTOS_TRACE_ISR_ENTER();
 
-    //If number of threads is less than max threads
-    if(NumberOfThreads < MAX_THREADS)
-    {
-        //Looks for the first dead thread
-        uint32_t index;
-        for(index = 0; index < MAX_THREADS; ++index)
-        {
-            if(!threadControlBlocks[index].isAlive)
-            {
-                threadControlBlocks[index].threadID =
-                        ((IDCounter++) << 16) | (uint32_t)&threadControlBlocks[index];
-                break;
-            }
-        }
+    //SysTick counts down from LOAD after the tick, so what it counted since is the entry latency
+    G8RTOS_PROBE_SAMPLE(PROBE_SYSTICK_LATENCY, SysTick->LOAD - SysTick->VAL);
 
-        //When no threads exist
-        if (NumberOfThreads == 0)
-        {
-            //Makes new thread point to itself
-            threadControlBlocks[index].prev = &threadControlBlocks[index];
-            threadControlBlocks[index].next = &threadControlBlocks[index];
-        }
-        else
-        {
-            //Finds closest left and right nodes
-            uint32_t leftIndex = findLeftNode(index);
-            uint32_t rightIndex = findRightNode(index);
+    //Increments system time
+    SystemTime++;
+    idleStats.tickInterrupts++;
 
-            //Inserts into linked list
-            threadControlBlocks[index].prev = &threadControlBlocks[leftIndex];
-            threadControlBlocks[index].next = &threadControlBlocks[rightIndex];
+    //Runs every periodic event that is due, the heap top is always the next one
+    while(NumberOfPthreads && TIME_REACHED(SystemTime, PthreadHeap[0]->executeTime))
+    {
+        ptcb_t *event = PthreadHeap[0];
 
+#if G8RTOS_DEFERRED_PERIODIC
+        //Worker thread runs the handler
+        PeriodicMarkDue(event);
 
-            threadControlBlocks[leftIndex].next = &threadControlBlocks[index];
-            threadControlBlocks[rightIndex].prev = &threadControlBlocks[index];
+        //Moves execute time to the next release
+        PeriodicAdvance(event);
+#else
+        //Records how late the release is
+        PeriodicRecordLateness(event, SystemTime - event->executeTime);
 
-        }
-        //Makes thread start awake
-        threadControlBlocks[index].asleep = 0;
+        //Moves execute time to the next release
+        PeriodicAdvance(event);
 
-        //Makes thread sleep count equal 0
-        threadControlBlocks[index].sleepCount = 0;
+        //Runs Periodic thread
+        (*(event->Handler))();
+#endif
 
-        //Makes blocked semaphore 0
-        threadControlBlocks[index].blocked = 0;
+        //Puts event back into its place in the heap
+        HeapSiftDown(0);
+    }
 
-        //Initializes priority
-        threadControlBlocks[index].priority = priority;
+    //Set when the scheduler has to run at the end of the tick
+    bool reschedule = false;
+    tcb_t *running = CurrentlyRunningThread;
 
-        //Initializes alive status
-        threadControlBlocks[index].isAlive = true;
+    //Wakes up threads whose time has come, only the head of the sleep queue counts down
+    if(sleepQueue)
+    {
+        sleepQueue->sleepDelta--;
 
-        //Sets name to be assigned for tcb
-        strcpy(threadControlBlocks[index].threadName, name);
+        while(sleepQueue && (sleepQueue->sleepDelta == 0))
+        {
+            //Pops thread from the sleep queue
+            tcb_t *temp = sleepQueue;
+            sleepQueue = temp->sleepNext;
+            if(sleepQueue)
+            {
+                sleepQueue->sleepPrev = 0;
+            }
 
-        //Sets thumbbit in xPSR
-        threadStacks[index][STACKSIZE - 1] = THUMBBIT;
+            //Thread woken up and can be scheduled again
+            temp->asleep = false;
 
-        //Sets PC to function pointer
-        threadStacks[index][STACKSIZE - 2] = (uint32_t)threadToAdd;
+            //Wait with a timeout ran out
+            if(temp->blocked)
+            {
+                G8RTOS_WaitQueueRemove(temp);
+                temp->timedOut = true;
+            }
 
-        //Fills R0 to R14 with dummy values
-        for (uint8_t i = 3; i <= 16; i++)
-            threadStacks[index][STACKSIZE - i] = 1;
+            G8RTOS_ReadyInsert(temp);
+            G8RTOS_TRACE_EVENT(TRACE_WAKE, temp, 0);
 
-        //Sets sp pointer to point to top of stack pointer address
-        threadControlBlocks[index].sp = &threadStacks[index][STACKSIZE - 16];
+            //Preempts a lower priority thread, equal priorities wait for their turn
+            if(temp->priority < running->priority)
+            {
+                reschedule = true;
+            }
+        }
+    }
 
-        //Increments number of threads
-        NumberOfThreads++;
+    //Running thread left the head of its ready list (blocked, killed or moved), let the scheduler pick
+    if(readyList[running->priority] != running)
+    {
+        reschedule = true;
+    }
+    //Time slice ran out, next thread of the same priority gets a turn (EDF threads keep deadline order)
+    else if(!running->edfPeriod && (--running->sliceLeft == 0))
+    {
+        running->sliceLeft = sliceTicks[running->priority];
 
-        EndCriticalSection(priMask);
+        if(running->readyNext != running)
+        {
+            readyList[running->priority] = running->readyNext;
+            reschedule = true;
+        }
+    }
 
-        return SUCCESS;
+    //Sets PendSV flag only when another thread should run
+    if(reschedule)
+    {
+        SCB->ICSR |= (1<<28);
     }
-    else
+
+    G8RTOS_TRACE_ISR_EXIT();
+
+    //Keeps worst case duration
+    uint32_t cycles = DWT->CYCCNT - startCycles;
+    if(cycles > tickMaxCycles)
     {
-        EndCriticalSection(priMask);
-        return ERROR;
+        tickMaxCycles = cycles;
     }
+    G8RTOS_PROBE_SAMPLE(PROBE_SYSTICK, cycles);
 }
 
-
 /*
- * Adds periodic threads to G8RTOS Scheduler
- * Function will initialize a periodic event struct to represent event.
- * The struct will be added to a linked list of periodic events
- * Param Pthread To Add: void-void function for P thread handler
- * Param period: period of P thread to add
- * Returns: Error code for adding threads
+ * Returns true if a thread is in the ready list of its priority
+ */
+static inline bool ThreadIsReady(tcb_t *thread)
+{
+    return !thread->asleep && !thread->blocked && !thread->suspended;
+}
+
+/*
+ * Finds a live thread from its ID in constant time
+ *  - IDs of killed threads are stale (the slot's generation changed) and are rejected
+ *  - Must be called inside of a critical section
+ * Param "threadID": ID to look up
+ * Returns: thread, 0 if the ID is not a live thread
+ */
+static tcb_t *FindThread(threadID_t threadID)
+{
+    uint32_t index = threadID & THREAD_INDEX_MASK;
+
+    if((index >= MAX_THREADS) ||
+       !threadControlBlocks[index].isAlive ||
+       (threadControlBlocks[index].threadID != threadID))
+    {
+        return 0;
+    }
+
+    return &threadControlBlocks[index];
+}
+
+/*
+ * Inserts a thread into the sleep queue
+ *  - Walks the queue subtracting deltas until the wake up time fits
+ *  - Threads with the same wake up time keep the order they went to sleep in
+ *  - Must be called inside of a critical section
+ * Param "thread": thread going to sleep
+ * Param "ticks": number of ticks to sleep for (at least 1)
+ */
+static void SleepQueueInsert(tcb_t *thread, uint32_t ticks)
+{
+    tcb_t *prev = 0;
+    tcb_t *curr = sleepQueue;
+
+    //A thread always sleeps until at least the next tick
+    if(ticks == 0)
+    {
+        ticks = 1;
+    }
+
+    //Finds first thread that wakes up later
+    while(curr && (ticks >= curr->sleepDelta))
+    {
+        ticks -= curr->sleepDelta;
+        prev = curr;
+        curr = curr->sleepNext;
+    }
+
+    //Links thread in between prev and curr
+    thread->sleepDelta = ticks;
+    thread->sleepPrev = prev;
+    thread->sleepNext = curr;
+
+    if(prev)
+    {
+        prev->sleepNext = thread;
+    }
+    else
+    {
+        sleepQueue = thread;
+    }
+
+    //Thread behind the new one now counts from the new one's wake up time
+    if(curr)
+    {
+        curr->sleepDelta -= ticks;
+        curr->sleepPrev = thread;
+    }
+}
+
+/*
+ * Removes a thread from the sleep queue before it wakes up
+ *  - Must be called inside of a critical section
+ * Param "thread": sleeping thread to remove
+ */
+static void SleepQueueRemove(tcb_t *thread)
+{
+    //Thread behind inherits the removed thread's delta
+    if(thread->sleepNext)
+    {
+        thread->sleepNext->sleepDelta += thread->sleepDelta;
+        thread->sleepNext->sleepPrev = thread->sleepPrev;
+    }
+
+    if(thread->sleepPrev)
+    {
+        thread->sleepPrev->sleepNext = thread->sleepNext;
+    }
+    else
+    {
+        sleepQueue = thread->sleepNext;
+    }
+}
+
+/*
+ * Takes a thread out of the scheduler
+ *  - Unlinks it from the sleep queue (or the G8RTOS_SleepUs queue), its wait queue or its ready list
+ *  - Releases its mutexes and frees its stack and handle table slot
+ *  - Must be called inside of a critical section
+ * Param "thread": live thread to kill
+ */
+static void RemoveThread(tcb_t *thread)
+{
+    bool ready = ThreadIsReady(thread);
+
+    //Kill thread
+    thread->isAlive = false;
+
+    if(thread->asleep)
+    {
+#if G8RTOS_HIRES_TIME
+        if(thread->sleepingUs)
+        {
+            G8RTOS_SleepUsRemove(thread);
+        }
+        else
+#endif
+        {
+            SleepQueueRemove(thread);
+        }
+    }
+
+    if(thread->blocked)
+    {
+        G8RTOS_WaitQueueRemove(thread);
+    }
+
+    if(ready)
+    {
+        G8RTOS_ReadyRemove(thread);
+    }
+
+    //Releases mutexes it holds
+    G8RTOS_MutexKillThread(thread);
+
+    //Wakes every thread joining it
+    while(thread->joiners.head)
+    {
+        G8RTOS_WaitQueueWakeThread(thread->joiners.head);
+    }
+
+    //Running thread still needs its stack to save its context, so it is reaped by the scheduler
+    if(thread == CurrentlyRunningThread)
+    {
+        pendingReap = thread;
+    }
+    else
+    {
+        ReapThread(thread);
+    }
+
+    //Decreases number of threads
+    NumberOfThreads--;
+}
+
+#if G8RTOS_TICKLESS
+/*
+ * Finds the number of ticks until the next thread wakes up or periodic event runs
+ *  - Limited to the longest time SysTick can count
+ *  - Must be called inside of a critical section
+ */
+static uint32_t NextDeadline(void)
+{
+    uint32_t ticks = maxIdleTicks;
+
+    //Sleep queue head is the next thread to wake up
+    if(sleepQueue && (sleepQueue->sleepDelta < ticks))
+    {
+        ticks = sleepQueue->sleepDelta;
+    }
+
+    //Periodic events run when system time reaches their execute time, heap top is the next one
+    if(NumberOfPthreads)
+    {
+        int32_t untilEvent = (int32_t)(PthreadHeap[0]->executeTime - SystemTime);
+        if(untilEvent < (int32_t)ticks)
+        {
+            ticks = (untilEvent > 0) ? untilEvent : 0;
+        }
+    }
+
+    return ticks;
+}
+
+/*
+ * Moves system time forward for ticks that passed while the tick was stopped
+ *  - Never passes a deadline, so nothing has to be woken up
+ *  - Must be called inside of a critical section
+ * Param "ticks": number of ticks that passed
+ */
+static void StepTicks(uint32_t ticks)
+{
+    SystemTime += ticks;
+
+    if(sleepQueue)
+    {
+        sleepQueue->sleepDelta -= ticks;
+    }
+}
+
+/*
+ * Restarts SysTick so its next interrupt lands on the next tick boundary
+ * Param "cyclesToTick": cycles left until next tick boundary
+ */
+static void RestartTick(uint32_t cyclesToTick)
+{
+    SysTick->LOAD = cyclesToTick - 1;
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+    //Takes effect on the next reload, so ticks go back to 1ms
+    SysTick->LOAD = cyclesPerTick - 1;
+}
+#endif
+
+#if G8RTOS_MONITOR
+/*
+ * Monitor thread
+ *  - Prints the stack usage and CPU usage tables every MONITOR_PERIOD ms
+ *  - With G8RTOS_INSTRUMENT, also prints the probe report and checks probe budgets
+ */
+static void Monitor(void)
+{
+#if G8RTOS_TRACE
+    uint32_t nextTraceDump = SystemTime + TRACE_DUMP_PERIOD;
+#endif
+
+    while(1)
+    {
+        G8RTOS_Sleep(MONITOR_PERIOD);
+
+#if G8RTOS_TRACE
+        //Drains the trace ring before it wraps too far, records that came in while dumping are counted as dropped
+        if(TIME_REACHED(SystemTime, nextTraceDump))
+        {
+            G8RTOS_TraceDump();
+            nextTraceDump = SystemTime + TRACE_DUMP_PERIOD;
+        }
+#endif
+
+        G8RTOS_PrintStackUsage();
+        G8RTOS_PrintThreadStats();
+
+        //Cycles taken by integer only and FPU context switches
+        G8RTOS_PrintSwitchStats();
+
+#if G8RTOS_TICKLESS
+        //Wake ups and time asleep since the last period
+        G8RTOS_PrintIdleStats();
+#endif
+
+#if G8RTOS_LATENCY_PROBE
+        //Worst latency of the probe interrupt since the last period
+        G8RTOS_PrintLatencyStats();
+#endif
+
+#if G8RTOS_INSTRUMENT
+        //Kernel path timings, and any path over its budget
+        G8RTOS_PrintProbeReport();
+        G8RTOS_CheckProbeBudgets();
+#endif
+    }
+}
+#endif
+
+/*********************************************** Private Functions ********************************************************************/
+
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+/*
+ * Adds a thread to the tail of the ready list for its priority
+ *  - Suspended threads stay out of the ready list until resumed
+ *  - Must be called inside of a critical section
+ * Param "thread": thread that is now able to run
+ */
+void G8RTOS_ReadyInsert(tcb_t *thread)
+{
+    if(thread->suspended)
+    {
+        return;
+    }
+
+    uint8_t priority = thread->priority;
+    tcb_t *head = readyList[priority];
+
+    //Gets a full slice for its next turn
+    thread->sliceLeft = sliceTicks[priority];
+
+    //If list is empty, thread points to itself and priority is marked ready
+    if(!head)
+    {
+        thread->readyNext = thread;
+        thread->readyPrev = thread;
+        readyList[priority] = thread;
+
+        readyBitmap[priority >> 5] |= (0x80000000 >> (priority & 31));
+        readyGroup |= (0x80000000 >> (priority >> 5));
+    }
+    else if((priority == EDF_PRIORITY) && thread->edfPeriod)
+    {
+        //Finds first thread due later, fixed priority threads at this level count as due last
+        tcb_t *next = head;
+        bool earliest = true;
+        while(next->edfPeriod && !TIME_BEFORE(thread->edfKey, next->edfKey))
+        {
+            next = next->readyNext;
+            earliest = false;
+            if(next == head)
+            {
+                break;
+            }
+        }
+
+        //Inserts in front of it
+        thread->readyNext = next;
+        thread->readyPrev = next->readyPrev;
+        next->readyPrev->readyNext = thread;
+        next->readyPrev = thread;
+
+        //Earliest deadline runs first
+        if(earliest)
+        {
+            readyList[priority] = thread;
+        }
+    }
+    else
+    {
+        //Inserts behind the head so it is the last to run
+        thread->readyNext = head;
+        thread->readyPrev = head->readyPrev;
+        head->readyPrev->readyNext = thread;
+        head->readyPrev = thread;
+    }
+}
+
+/*
+ * Removes a thread from the ready list for its priority
+ *  - Must be called inside of a critical section
+ * Param "thread": thread that is no longer able to run (asleep, blocked or killed)
+ */
+void G8RTOS_ReadyRemove(tcb_t *thread)
+{
+    uint8_t priority = thread->priority;
+
+    //If thread is the only one in the list, priority is no longer ready
+    if(thread->readyNext == thread)
+    {
+        readyList[priority] = 0;
+
+        readyBitmap[priority >> 5] &= ~(0x80000000 >> (priority & 31));
+        if(!readyBitmap[priority >> 5])
+        {
+            readyGroup &= ~(0x80000000 >> (priority >> 5));
+        }
+    }
+    else
+    {
+        //Unlinks thread from list
+        thread->readyPrev->readyNext = thread->readyNext;
+        thread->readyNext->readyPrev = thread->readyPrev;
+
+        //Moves head if the removed thread was next to run
+        if(readyList[priority] == thread)
+        {
+            readyList[priority] = thread->readyNext;
+        }
+    }
+}
+
+/*
+ * Links a thread into a wait queue, in the queue's wake up order
+ *  - Must be called inside of a critical section
+ * Param "queue": wait queue to link into
+ * Param "thread": thread to link
+ */
+static void WaitQueueLink(waitQueue_t *queue, tcb_t *thread)
+{
+    tcb_t *next = 0;
+
+    //Priority order skips past every thread of equal or higher priority, EDF threads also go ahead of EDF threads due later
+    if(queue->order == WAIT_PRIORITY)
+    {
+        next = queue->head;
+        while(next && ((next->priority < thread->priority) ||
+                       ((next->priority == thread->priority) &&
+                        !(thread->edfPeriod && next->edfPeriod && TIME_BEFORE(thread->edfKey, next->edfKey)))))
+        {
+            next = next->waitNext;
+        }
+    }
+
+    //Links thread in front of next (at the tail when next is 0)
+    thread->waitNext = next;
+    thread->waitPrev = next ? next->waitPrev : queue->tail;
+
+    if(thread->waitPrev)
+    {
+        thread->waitPrev->waitNext = thread;
+    }
+    else
+    {
+        queue->head = thread;
+    }
+
+    if(next)
+    {
+        next->waitPrev = thread;
+    }
+    else
+    {
+        queue->tail = thread;
+    }
+
+    thread->blocked = queue;
+    thread->blockStart = DWT->CYCCNT;
+}
+
+/*
+ * Blocks a thread in a wait queue, in the queue's wake up order
+ *  - Thread must be running (in the ready list)
+ *  - Must be called inside of a critical section
+ * Param "queue": wait queue to block in
+ * Param "thread": thread to block
+ */
+void G8RTOS_WaitQueueInsert(waitQueue_t *queue, tcb_t *thread)
+{
+    WaitQueueLink(queue, thread);
+
+    //Thread cannot be scheduled until woken up
+    G8RTOS_ReadyRemove(thread);
+}
+
+/*
+ * Blocks a thread in a wait queue for at most a number of ms
+ *  - Thread also waits in the sleep queue, if the time runs out it leaves the wait queue with timedOut set
+ *  - Thread must be running (in the ready list)
+ *  - Must be called inside of a critical section
+ * Param "queue": wait queue to block in
+ * Param "thread": thread to block
+ * Param "timeout": ms to wait for (at least 1), WAIT_FOREVER to never time out
+ */
+void G8RTOS_WaitQueueInsertTimeout(waitQueue_t *queue, tcb_t *thread, uint32_t timeout)
+{
+    G8RTOS_WaitQueueInsert(queue, thread);
+    thread->timedOut = false;
+
+    if(timeout != WAIT_FOREVER)
+    {
+        thread->asleep = true;
+        SleepQueueInsert(thread, timeout);
+    }
+}
+
+/*
+ * Removes a thread from the wait queue it is blocked in without readying it
+ *  - Must be called inside of a critical section
+ * Param "thread": blocked thread
+ */
+void G8RTOS_WaitQueueRemove(tcb_t *thread)
+{
+    waitQueue_t *queue = thread->blocked;
+
+    if(thread->waitPrev)
+    {
+        thread->waitPrev->waitNext = thread->waitNext;
+    }
+    else
+    {
+        queue->head = thread->waitNext;
+    }
+
+    if(thread->waitNext)
+    {
+        thread->waitNext->waitPrev = thread->waitPrev;
+    }
+    else
+    {
+        queue->tail = thread->waitPrev;
+    }
+
+    //Charges the time spent waiting to the thread and the queue
+    uint32_t cycles = DWT->CYCCNT - thread->blockStart;
+    thread->blockedCycles += cycles;
+    queue->stats.waits++;
+    queue->stats.blockedCycles += cycles;
+
+    thread->blocked = 0;
+}
+
+/*
+ * Wakes the head of a wait queue and puts it back into the ready list
+ *  - Must be called inside of a critical section
+ * Param "queue": wait queue to wake from
+ * Returns: thread woken up, 0 if queue was empty
+ */
+tcb_t *G8RTOS_WaitQueueWake(waitQueue_t *queue)
+{
+    tcb_t *thread = queue->head;
+
+    if(thread)
+    {
+        G8RTOS_WaitQueueWakeThread(thread);
+    }
+
+    return thread;
+}
+
+/*
+ * Wakes a thread blocked in a wait queue and puts it back into the ready list
+ *  - Cancels its timeout
+ *  - Must be called inside of a critical section
+ * Param "thread": blocked thread
+ */
+void G8RTOS_WaitQueueWakeThread(tcb_t *thread)
+{
+    G8RTOS_WaitQueueRemove(thread);
+
+    //Woken before its timeout ran out
+    if(thread->asleep)
+    {
+        SleepQueueRemove(thread);
+        thread->asleep = false;
+    }
+
+    G8RTOS_ReadyInsert(thread);
+    G8RTOS_TRACE_EVENT(TRACE_WAKE, thread, 1);
+
+    //Runs woken thread right away if it outranks the running thread or is due before it
+    if((thread->priority < CurrentlyRunningThread->priority) ||
+       (readyList[CurrentlyRunningThread->priority] != CurrentlyRunningThread))
+    {
+        SCB->ICSR |= (1<<28);
+    }
+}
+
+/*
+ * Changes the priority a thread is scheduled with
+ *  - Moves the thread in its ready list or priority ordered wait queue
+ *  - Must be called inside of a critical section
+ * Param "thread": thread to change
+ * Param "priority": new effective priority
+ */
+void G8RTOS_SetEffectivePriority(tcb_t *thread, uint8_t priority)
+{
+    if(thread->priority == priority)
+    {
+        return;
+    }
+
+    if(thread->blocked)
+    {
+        //Moves thread to its new place in a priority ordered wait queue
+        waitQueue_t *queue = thread->blocked;
+        thread->priority = priority;
+
+        if(queue->order == WAIT_PRIORITY)
+        {
+            G8RTOS_WaitQueueRemove(thread);
+            WaitQueueLink(queue, thread);
+        }
+    }
+    else if(!ThreadIsReady(thread))
+    {
+        //Sleeping and suspended threads are not in any priority list
+        thread->priority = priority;
+    }
+    else
+    {
+        //Moves thread to the ready list of its new priority
+        G8RTOS_ReadyRemove(thread);
+        thread->priority = priority;
+        G8RTOS_ReadyInsert(thread);
+    }
+}
+
+/*
+ * Changes the deadline an EDF thread is ordered by
+ *  - Moves the thread in the EDF ready list or priority ordered wait queue it is in
+ *  - Must be called inside of a critical section
+ * Param "thread": EDF thread to change
+ * Param "deadline": new effective deadline, in system time
+ */
+void G8RTOS_SetEffectiveDeadline(tcb_t *thread, uint32_t deadline)
+{
+    if(thread->edfKey == deadline)
+    {
+        return;
+    }
+
+    if(thread->blocked)
+    {
+        //Moves thread to its new place among EDF waiters of its priority
+        waitQueue_t *queue = thread->blocked;
+        thread->edfKey = deadline;
+
+        if(queue->order == WAIT_PRIORITY)
+        {
+            G8RTOS_WaitQueueRemove(thread);
+            WaitQueueLink(queue, thread);
+        }
+    }
+    //Only the EDF ready list is ordered by deadline, a thread boosted above it just keeps the new one
+    else if(ThreadIsReady(thread) && (thread->priority == EDF_PRIORITY))
+    {
+        G8RTOS_ReadyRemove(thread);
+        thread->edfKey = deadline;
+        G8RTOS_ReadyInsert(thread);
+    }
+    else
+    {
+        thread->edfKey = deadline;
+    }
+}
+
+/*
+ * Copies the ID and name of the thread in a handle table slot
+ * Param "index": slot in the handle table
+ * Param "threadID": filled with the thread's ID, its generation is above the slot
+ * Param "name": buffer of MAX_NAME_LENGTH chars to fill
+ * Returns: false if no live thread is in the slot
+ */
+bool G8RTOS_GetSlotThread(uint32_t index, threadID_t *threadID, char *name)
+{
+    int32_t priMask = StartCriticalSection();
+
+    bool alive = threadControlBlocks[index].isAlive;
+    if(alive)
+    {
+        *threadID = threadControlBlocks[index].threadID;
+        strcpy(name, threadControlBlocks[index].threadName);
+    }
+
+    EndCriticalSection(priMask);
+    return alive;
+}
+
+/* IRQ that called the kernel from above KERNEL_IRQ_PRIORITY, for the debugger */
+static volatile uint32_t kernelPriorityFaultIRQn;
+
+/*
+ * Stops the system when a kernel function is called from an interrupt above KERNEL_IRQ_PRIORITY
+ *  - The kernel never masks those interrupts, so letting the call go on would corrupt its lists
+ *  - Called by StartCriticalSection, never returns
+ * Param "IRQn": interrupt that called the kernel
+ */
+void G8RTOS_KernelPriorityFault(uint32_t IRQn)
+{
+    StartCriticalSectionAll();
+    kernelPriorityFaultIRQn = IRQn;
+
+    while(1);
+}
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+
+/*********************************************** Public Variables *********************************************************************/
+
+/* Holds the current time for the whole System */
+uint32_t SystemTime;
+
+/*********************************************** Public Variables *********************************************************************/
+
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Sets variables to an initial state (system time and number of threads)
+ * Enables board for highest speed clock and disables watchdog
+ */
+void G8RTOS_Init()
+{
+    //Sets system time to 0
+    SystemTime = 0;
+
+    //Sets number of threads to 0
+    NumberOfThreads = 0;
+
+    //Sets number of periodic threads to 0
+    NumberOfPthreads = 0;
+
+    //Every slot of the handle table starts free, slot 0 is used first
+    for(uint32_t i = 0; i < MAX_THREADS; ++i)
+    {
+        freeSlots[i] = MAX_THREADS - 1 - i;
+    }
+    freeSlotCount = MAX_THREADS;
+    pendingReap = 0;
+
+    //Splits the stack pool into its size classes
+    G8RTOS_StackPoolInit();
+
+    //Empties ready lists
+    memset(readyList, 0, sizeof(readyList));
+    memset(readyBitmap, 0, sizeof(readyBitmap));
+    readyGroup = 0;
+
+    //Every priority starts with the default time slice
+    memset(sliceTicks, DEFAULT_TIME_SLICE, sizeof(sliceTicks));
+
+    //Empties sleep queue
+    sleepQueue = 0;
+
+    //Clears idle statistics
+    memset(&idleStats, 0, sizeof(idleStats));
+
+    //Initializes board
+    BSP_InitBoard();
+
+    //Starts the DWT cycle counter used for kernel timing
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    tickMaxCycles = 0;
+    memset(contextSwitchStats, 0, sizeof(contextSwitchStats));
+
+    //Interrupts of threads that used the FPU reserve room for S0-S15, only saved if the handler uses the FPU
+    //PendSV_Handler saves S16-S31 for those threads only
+    FPU->FPCCR |= FPU_FPCCR_ASPEN_Msk | FPU_FPCCR_LSPEN_Msk;
+
+    //Relocates the ISR interrupt vector table to 0x20000000
+    uint32_t newVTORTable = 0x20000000;
+    memcpy((uint32_t *)newVTORTable, (uint32_t *)SCB->VTOR, 57*4); // 57 interrupt vectors to copy
+    SCB->VTOR = newVTORTable;
+
+#if G8RTOS_HIRES_TIME
+    //Starts the us timebase, vectors go into the relocated table
+    G8RTOS_TimeInit();
+#endif
+
+#if G8RTOS_DEFERRED_PERIODIC
+    //Starts the worker thread that runs periodic event handlers
+    dueHead = 0;
+    dueCount = 0;
+    G8RTOS_InitSemaphore(&periodicDue, 0);
+    G8RTOS_AddThread(PeriodicWorker, PERIODIC_WORKER_PRIORITY, 256, "PERIODIC");
+#endif
+
+#if G8RTOS_TIMERS
+    //Starts the thread that fires software timers
+    G8RTOS_TimerServiceInit();
+#endif
+
+#if G8RTOS_MONITOR
+    //Starts the thread that reports stack and CPU usage
+    G8RTOS_AddThread(Monitor, MONITOR_PRIORITY, 256, "MONITOR");
+#endif
+
+#if G8RTOS_LATENCY_PROBE
+    //Measures the latency an interrupt above the kernel sees, vector goes into the relocated table
+    G8RTOS_StartLatencyProbe(LATENCY_PROBE_PRIORITY);
+#endif
+}
+
+/*
+ * Starts G8RTOS Scheduler
+ * 	- Initializes the Systick
+ * 	- Sets Context to thread with highest priority
+ * Returns: Error Code for starting scheduler. This will only return if the scheduler fails
+ */
+int G8RTOS_Launch()
+{
+    //Cannot launch without threads
+    if(NumberOfThreads == 0)
+    {
+        return NO_THREADS_SCHEDULED;
+    }
+
+    //Makes currently running thread the thread with highest priority
+    G8RTOS_Scheduler();
+
+    //Gets clock frequency
+    uint32_t clkFreq = ClockSys_GetSysFreq();
+
+    //Initializes SysTick
+    cyclesPerTick = clkFreq/1000;
+    InitSysTick(cyclesPerTick);
+
+#if G8RTOS_TICKLESS
+    //Longest idle period SysTick can count in one go
+    maxIdleTicks = SysTick_LOAD_RELOAD_Msk / cyclesPerTick;
+#endif
+
+    //Sets priorities for PENDSV and SysTick
+    NVIC_SetPriority(PendSV_IRQn, 7);
+
+    //Call G8RTOS_Start
+    G8RTOS_Start();
+
+    return ERROR;
+}
+
+/*
+ * Adds threads to G8RTOS Scheduler
+ * 	- Checks if there are stil available threads to insert to scheduler
+ * 	- Initializes the thread control block for the provided thread
+ * 	- Takes a stack from the smallest stack pool class that holds stackSize
+ * 	- Initializes the stack for the provided thread to hold a "fake context"
+ * 	- Sets stack tcb stack pointer to top of thread stack
+ * 	- Adds the thread to the ready list of its priority
+ * Param "threadToAdd": Void-Void Function to add as preemptable main thread
+ * Param "priority": specified priority of new thread
+ * Param "stackSize": stack size needed by the thread, in words
+ * Param "name": Name given to thread
+ * Returns: Error code for adding threads, ERROR if no slot or stack is free
+ */
+int G8RTOS_AddThread(void (*threadToAdd)(void), uint8_t priority, uint32_t stackSize, char* name)
+{
+    int32_t priMask = StartCriticalSection();
+    G8RTOS_PROBE_START();
+
+    //If a slot is free (a thread that killed itself holds its slot until it is reaped)
+    if(freeSlotCount > 0)
+    {
+        //Takes a stack big enough for the thread
+        uint32_t actualSize;
+        int32_t *stack = G8RTOS_StackAlloc(stackSize, &actualSize);
+        if(!stack)
+        {
+            EndCriticalSection(priMask);
+            return ERROR;
+        }
+
+        //Takes a free slot of the handle table
+        uint32_t index = freeSlots[--freeSlotCount];
+        threadControlBlocks[index].stackBase = stack;
+        threadControlBlocks[index].stackSize = actualSize;
+
+        //Paints stack so its high-water mark can be measured
+        G8RTOS_StackPaint(stack, actualSize);
+
+        //Bumps the slot's generation so IDs of threads that used it before become stale
+        threadControlBlocks[index].threadID =
+                ((threadControlBlocks[index].threadID >> THREAD_GENERATION_SHIFT) + 1) << THREAD_GENERATION_SHIFT | index;
+
+        //Makes thread start awake
+        threadControlBlocks[index].asleep = 0;
+        threadControlBlocks[index].sleepingUs = false;
+        threadControlBlocks[index].suspended = false;
+
+        //Makes thread sleep delta equal 0
+        threadControlBlocks[index].sleepDelta = 0;
+
+        //Makes blocked semaphore 0
+        threadControlBlocks[index].blocked = 0;
+        threadControlBlocks[index].timedOut = false;
+        threadControlBlocks[index].waitData = 0;
+
+        //Starts in the fixed priority class
+        threadControlBlocks[index].edfPeriod = 0;
+        threadControlBlocks[index].edfKey = 0;
+        memset(&threadControlBlocks[index].edfStats, 0, sizeof(edfStats_t));
+
+        //Starts CPU accounting
+        threadControlBlocks[index].runCycles = 0;
+        threadControlBlocks[index].blockedCycles = 0;
+        threadControlBlocks[index].switchesIn = 0;
+        threadControlBlocks[index].reportRunCycles = 0;
+        threadControlBlocks[index].reportBlockedCycles = 0;
+        threadControlBlocks[index].reportSwitchesIn = 0;
+
+        //Initializes priority
+        threadControlBlocks[index].priority = priority;
+        threadControlBlocks[index].basePriority = priority;
+
+        //Thread starts without mutexes
+        threadControlBlocks[index].blockedMutex = 0;
+        threadControlBlocks[index].heldMutexes = 0;
+
+        //Thread starts with nobody joining it
+        threadControlBlocks[index].joiners.head = 0;
+        threadControlBlocks[index].joiners.tail = 0;
+        threadControlBlocks[index].joiners.order = WAIT_PRIORITY;
+        threadControlBlocks[index].joiners.stats.waits = 0;
+        threadControlBlocks[index].joiners.stats.blockedCycles = 0;
+
+        //Initializes alive status
+        threadControlBlocks[index].isAlive = true;
+
+        //Sets name to be assigned for tcb, longer names are cut to fit
+        strncpy(threadControlBlocks[index].threadName, name, MAX_NAME_LENGTH - 1);
+        threadControlBlocks[index].threadName[MAX_NAME_LENGTH - 1] = '\0';
+        G8RTOS_TRACE_THREAD_START(&threadControlBlocks[index]);
+
+        //Sets thumbbit in xPSR
+        stack[actualSize - 1] = THUMBBIT;
+
+        //Sets PC to function pointer
+        stack[actualSize - 2] = (uint32_t)threadToAdd;
+
+        //Fills R0 to R14 and the EXC_RETURN slot with dummy values
+        for (uint8_t i = 3; i <= 17; i++)
+            stack[actualSize - i] = 1;
+
+        //Thread starts without FPU state, so PendSV_Handler has no S16-S31 to restore
+        stack[actualSize - 9] = EXC_RETURN_THREAD_BASIC;
+
+        //Sets sp pointer to point to top of stack pointer address
+        threadControlBlocks[index].sp = &stack[actualSize - 17];
+
+        //New thread is ready to run
+        G8RTOS_ReadyInsert(&threadControlBlocks[index]);
+
+        //Increments number of threads
+        NumberOfThreads++;
+
+        //Time interrupts were masked for
+        G8RTOS_PROBE_END(PROBE_ADD_THREAD);
+
+        EndCriticalSection(priMask);
+        return SUCCESS;
+    }
+    else
+    {
+        EndCriticalSection(priMask);
+        return ERROR;
+    }
+}
+
+
+/*
+ * Adds periodic threads to G8RTOS Scheduler
+ * Function will initialize a periodic event struct to represent event.
+ * The struct will be added to the min-heap of periodic events
+ * Events are offset by 1ms from each other so they do not all run on the same tick
+ * Param Pthread To Add: void-void function for P thread handler
+ * Param period: period of P thread to add
+ * Returns: Error code for adding threads
  */
 int G8RTOS_AddPeriodicEvent(void (*PthreadToAdd)(void), uint32_t period)
+{
+    return G8RTOS_AddPeriodicEventPolicy(PthreadToAdd, period, NumberOfPthreads, PERIODIC_SKIP);
+}
+
+/*
+ * Adds periodic threads to G8RTOS Scheduler with a chosen phase and late release policy
+ * Param Pthread To Add: void-void function for P thread handler
+ * Param period: period of P thread to add in ms
+ * Param phase: extra delay in ms before the first release
+ * Param policy: what to do with missed releases
+ * Returns: Error code for adding threads
+ */
+int G8RTOS_AddPeriodicEventPolicy(void (*PthreadToAdd)(void), uint32_t period, uint32_t phase, periodicPolicy_t policy)
+{
+    //A period of 0 would run forever in the tick
+    if(period == 0)
+    {
+        return PERIOD_INVALID;
+    }
+
+    int32_t priMask = StartCriticalSection();
+
+    //If number of periodic threads is equal to maximum, then more cannot be added
+    if(NumberOfPthreads == MAXPTHREADS)
+    {
+        EndCriticalSection(priMask);
+        return THREAD_LIMIT_REACHED;
+    }
+
+    //Initializes new periodic event
+    ptcb_t *event = &Pthread[NumberOfPthreads];
+    event->Handler = PthreadToAdd;
+    event->period = period;
+    event->executeTime = SystemTime + period + phase;
+    event->policy = policy;
+    memset(&event->stats, 0, sizeof(event->stats));
+
+    //Adds it to the bottom of the heap and moves it up to its place
+    PthreadHeap[NumberOfPthreads] = event;
+    NumberOfPthreads++;
+    HeapSiftUp(NumberOfPthreads - 1);
+
+    EndCriticalSection(priMask);
+    return SUCCESS;
+}
+
+/*
+ * Copies the statistics of a periodic event
+ * Param PthreadToFind: handler the event was added with
+ * Param stats: struct to fill
+ * Returns: Error code, THREAD_DOES_NOT_EXIST if no event uses that handler
+ */
+sched_ErrCode_t G8RTOS_GetPeriodicStats(void (*PthreadToFind)(void), periodicStats_t *stats)
+{
+    for(uint32_t i = 0; i < NumberOfPthreads; ++i)
+    {
+        if(Pthread[i].Handler == PthreadToFind)
+        {
+            int32_t priMask = StartCriticalSection();
+            *stats = Pthread[i].stats;
+            EndCriticalSection(priMask);
+            return NO_ERROR;
+        }
+    }
+
+    return THREAD_DOES_NOT_EXIST;
+}
+
+
+/*
+ * Puts the current thread into a sleep state.
+ *  param durationMS: Duration of sleep time in ms
+ */
+void G8RTOS_Sleep(uint32_t durationMS)
+{
+    int32_t priMask = StartCriticalSection();
+
+    //Puts thread to sleep
+    CurrentlyRunningThread->asleep = true;
+    G8RTOS_TRACE_EVENT(TRACE_SLEEP, 0, durationMS);
+
+    //Sleeping thread cannot be scheduled and waits in the sleep queue
+    G8RTOS_ReadyRemove(CurrentlyRunningThread);
+    SleepQueueInsert(CurrentlyRunningThread, durationMS);
+
+    EndCriticalSection(priMask);
+
+    //Sets PendSV flag, to yield CPU
+    SCB->ICSR |= (1<<28);
+}
+
+/*
+ * Puts the current thread into a sleep state until an absolute system time.
+ *  param wakeTime: SystemTime (in ms) to wake up at, returns at once if it has already passed
+ */
+void G8RTOS_SleepUntil(uint32_t wakeTime)
+{
+    uint32_t now = SystemTime;
+
+    //Wake up time already passed, so the caller is running late
+    if(TIME_REACHED(now, wakeTime))
+    {
+        return;
+    }
+
+    G8RTOS_Sleep(wakeTime - now);
+}
+
+/*
+ * Returns the most clock cycles a single SysTick_Handler has taken since the last call, then restarts counting
+ */
+uint32_t G8RTOS_GetTickMaxCycles(void)
+{
+    int32_t priMask = StartCriticalSection();
+
+    uint32_t cycles = tickMaxCycles;
+    tickMaxCycles = 0;
+
+    EndCriticalSection(priMask);
+    return cycles;
+}
+
+/*
+ * Called in a loop by the idle thread
+ *  - With G8RTOS_TICKLESS, stops the tick until the next sleep or periodic deadline and puts the CPU in LPM0 (WFI)
+ *  - On wake up, system time is corrected from the SysTick count
+ *  - Without G8RTOS_TICKLESS, returns right away
+ */
+void G8RTOS_Idle(void)
+{
+    //Time in this thread counts as idle time
+    idleThread = CurrentlyRunningThread;
+
+#if G8RTOS_TICKLESS
+    //Masks every interrupt, WFI only wakes up for interrupts BASEPRI lets through
+    int32_t priMask = StartCriticalSectionAll();
+
+    //Another thread is waiting for the CPU, let the scheduler run it
+    if((SCB->ICSR & SCB_ICSR_PENDSVSET_Msk) || (CurrentlyRunningThread->readyNext != CurrentlyRunningThread))
+    {
+        EndCriticalSectionAll(priMask);
+        return;
+    }
+
+    uint32_t ticks = NextDeadline();
+
+    //Stops SysTick and gets cycles left until the next tick
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    uint32_t cyclesToTick = SysTick->VAL;
+
+    //Not worth stopping the tick, or a tick is already pending
+    if((ticks < 2) || (cyclesToTick == 0) || (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk))
+    {
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+        __WFI();
+        idleStats.wakeups++;
+        EndCriticalSectionAll(priMask);
+        return;
+    }
+
+    //Interrupts once at the deadline instead of every tick
+    uint32_t idleCycles = cyclesToTick + ((ticks - 1) * cyclesPerTick);
+    SysTick->LOAD = idleCycles - 1;
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+    //Sleeps until any interrupt, interrupts stay masked so time can be fixed first
+    __DSB();
+    __WFI();
+    __ISB();
+
+    //Stops SysTick, reading CTRL also clears COUNTFLAG
+    uint32_t ctrl = SysTick->CTRL;
+    SysTick->CTRL = ctrl & ~SysTick_CTRL_ENABLE_Msk;
+
+    if(ctrl & SysTick_CTRL_COUNTFLAG_Msk)
+    {
+        //Deadline reached, the pending SysTick interrupt counts the last tick
+        uint32_t lateCycles = (idleCycles - 1) - SysTick->VAL;
+        StepTicks(ticks - 1);
+        RestartTick((lateCycles < cyclesPerTick) ? (cyclesPerTick - lateCycles) : 1);
+        idleStats.idleCycles += idleCycles;
+    }
+    else
+    {
+        //Woken early by another interrupt, counts only the full ticks that passed
+        uint32_t sleptCycles = (idleCycles - 1) - SysTick->VAL;
+        uint32_t sinceTick = sleptCycles + (cyclesPerTick - cyclesToTick);
+        StepTicks(sinceTick / cyclesPerTick);
+        RestartTick(cyclesPerTick - (sinceTick % cyclesPerTick));
+        idleStats.idleCycles += sleptCycles;
+    }
+
+    idleStats.wakeups++;
+
+    //Pending interrupts run here
+    EndCriticalSectionAll(priMask);
+#endif
+}
+
+/*
+ * Copies idle statistics counted since the last call, then restarts counting
+ *  param stats: struct to fill
+ */
+void G8RTOS_GetIdleStats(idleStats_t *stats)
+{
+    static uint32_t lastSystemTime;
+
+    int32_t priMask = StartCriticalSection();
+
+    *stats = idleStats;
+    stats->elapsedMS = SystemTime - lastSystemTime;
+
+    //Restarts counting
+    lastSystemTime = SystemTime;
+    memset(&idleStats, 0, sizeof(idleStats));
+
+    EndCriticalSection(priMask);
+}
+
+/*
+ * Prints wakeups per second and idle residency (percent of time asleep) to the back channel UART
+ */
+void G8RTOS_PrintIdleStats(void)
+{
+    idleStats_t stats;
+    G8RTOS_GetIdleStats(&stats);
+
+    //Nothing to report yet
+    if(stats.elapsedMS == 0)
+    {
+        return;
+    }
+
+    uint64_t totalCycles = (uint64_t)stats.elapsedMS * cyclesPerTick;
+
+    BackChannelPrintIntVariable("tickInterruptsPerSecond", (stats.tickInterrupts * 1000) / stats.elapsedMS);
+    BackChannelPrintIntVariable("wakeupsPerSecond", (stats.wakeups * 1000) / stats.elapsedMS);
+    BackChannelPrintIntVariable("idleResidencyPercent", (int32_t)((stats.idleCycles * 100) / totalCycles));
+}
+
+/*
+ * Copies context switch timing for every kind of switch, indexed by switchKind_t
+ *  param stats: array of NUMBER_OF_SWITCH_KINDS structs to fill
+ */
+void G8RTOS_GetSwitchStats(switchStats_t *stats)
+{
+    int32_t priMask = StartCriticalSection();
+    memcpy(stats, contextSwitchStats, sizeof(contextSwitchStats));
+    EndCriticalSection(priMask);
+}
+
+/*
+ * Prints last and longest context switch, in cycles, for every kind of switch to the back channel UART
+ */
+void G8RTOS_PrintSwitchStats(void)
+{
+    static const char *names[NUMBER_OF_SWITCH_KINDS] = {"fpuToFpu", "fpuToInt", "intToFpu", "intToInt"};
+    switchStats_t stats[NUMBER_OF_SWITCH_KINDS];
+    char name[24];
+
+    G8RTOS_GetSwitchStats(stats);
+
+    for(uint32_t i = 0; i < NUMBER_OF_SWITCH_KINDS; ++i)
+    {
+        snprintf(name, sizeof(name), "%sLastCycles", names[i]);
+        BackChannelPrintIntVariable(name, stats[i].lastCycles);
+        snprintf(name, sizeof(name), "%sMaxCycles", names[i]);
+        BackChannelPrintIntVariable(name, stats[i].maxCycles);
+    }
+}
+
+#if G8RTOS_SCHED_BENCHMARK
+/*
+ * Linear scan G8RTOS_Scheduler used before the ready lists, kept to compare against
+ *  - Walks every thread once from the one after the current thread, picks the highest priority one not blocked or asleep
+ *  - Threads are linked in a circle through readyNext, like the next pointer they used to have
+ */
+static tcb_t *LinearScan(tcb_t *current, uint32_t count)
+{
+    tcb_t *tempNextThread = current->readyNext;
+    tcb_t *chosen = current;
+    uint16_t currentMaxPriority = 256;
+
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        if((!tempNextThread->blocked) && (!tempNextThread->asleep))
+        {
+            if(tempNextThread->priority < currentMaxPriority)
+            {
+                chosen = tempNextThread;
+                currentMaxPriority = chosen->priority;
+            }
+        }
+        tempNextThread = tempNextThread->readyNext;
+    }
+
+    return chosen;
+}
+
+/*
+ * Times G8RTOS_Scheduler against the linear scan it replaced and prints both to the back channel UART
+ *  - Fills the ready lists with synthetic threads, MAX_THREADS caps real ones, then puts the real ready lists back
+ *  - Every third thread is asleep, priorities are spread so the highest one is not first in the circle
+ *  - Runs with every interrupt masked, the pick of each call is the same thread so no switch is recorded
+ *    (with G8RTOS_INSTRUMENT the PendSV probe still gets a sample per call)
+ *  param threads: number of synthetic threads, at most SCHED_BENCH_MAX_THREADS
+ */
+void G8RTOS_SchedulerBenchmark(uint32_t threads)
+{
+    if((threads == 0) || (threads > SCHED_BENCH_MAX_THREADS))
+    {
+        return;
+    }
+
+    memset(benchThreads, 0, sizeof(benchThreads));
+    for(uint32_t i = 0; i < threads; ++i)
+    {
+        benchThreads[i].priority = (uint8_t)(200 - ((i * 37) % 150));
+        benchThreads[i].basePriority = benchThreads[i].priority;
+        benchThreads[i].asleep = ((i % 3) == 2);
+        benchThreads[i].readyNext = &benchThreads[(i + 1) % threads];
+    }
+
+    int32_t priMask = StartCriticalSectionAll();
+
+    //Old scheduler, walks every thread each call
+    tcb_t *chosen = 0;
+    uint32_t start = DWT->CYCCNT;
+    for(uint32_t i = 0; i < SCHED_BENCH_ITERATIONS; ++i)
+    {
+        chosen = LinearScan(&benchThreads[0], threads);
+    }
+    uint32_t scanCycles = DWT->CYCCNT - start;
+
+    //Swaps the real ready lists out for the synthetic threads that can run
+    memcpy(benchSavedList, readyList, sizeof(readyList));
+    memcpy(benchSavedBitmap, readyBitmap, sizeof(readyBitmap));
+    uint32_t savedGroup = readyGroup;
+    tcb_t *savedRunning = CurrentlyRunningThread;
+    uint32_t savedSwitchCycles = lastSwitchCycles;
+
+    memset(readyList, 0, sizeof(readyList));
+    memset(readyBitmap, 0, sizeof(readyBitmap));
+    readyGroup = 0;
+    for(uint32_t i = 0; i < threads; ++i)
+    {
+        if(!benchThreads[i].asleep)
+        {
+            G8RTOS_ReadyInsert(&benchThreads[i]);
+        }
+    }
+
+    //Starts on the thread both schedulers pick, so every call keeps it
+    CurrentlyRunningThread = chosen;
+
+    start = DWT->CYCCNT;
+    for(uint32_t i = 0; i < SCHED_BENCH_ITERATIONS; ++i)
+    {
+        G8RTOS_Scheduler();
+    }
+    uint32_t bitmapCycles = DWT->CYCCNT - start;
+
+    //Puts the real threads back, the caller is charged for the time the benchmark took
+    memcpy(readyList, benchSavedList, sizeof(readyList));
+    memcpy(readyBitmap, benchSavedBitmap, sizeof(readyBitmap));
+    readyGroup = savedGroup;
+    CurrentlyRunningThread = savedRunning;
+    lastSwitchCycles = savedSwitchCycles;
+
+    EndCriticalSectionAll(priMask);
+
+    BackChannelPrintIntVariable("schedBenchThreads", threads);
+    BackChannelPrintIntVariable("schedScanCycles", scanCycles / SCHED_BENCH_ITERATIONS);
+    BackChannelPrintIntVariable("schedBitmapCycles", bitmapCycles / SCHED_BENCH_ITERATIONS);
+}
+
+/*
+ * Thread added by G8RTOS_SleepBenchmark
+ *  - Sleeps until the shared wake up time, then kills itself
+ */
+static void BenchSleeper(void)
+{
+    G8RTOS_SleepUntil(benchWakeTime);
+    G8RTOS_KillSelf();
+}
+
+/*
+ * Prints the longest SysTick_Handler, in cycles, with 0, 5, 10 and 20 threads asleep to the back channel UART
+ *  - Sleepers run at priority 0 so they are asleep before the next tick, and wake up on the same tick (the worst case)
+ *  - The caller sleeps past the wake up so the count covers every tick with the threads asleep and the wake up itself
+ */
+void G8RTOS_SleepBenchmark(void)
+{
+    static const uint32_t sleepers[] = {0, 5, 10, 20};
+
+    for(uint32_t run = 0; run < sizeof(sleepers) / sizeof(sleepers[0]); ++run)
+    {
+        benchWakeTime = SystemTime + SLEEP_BENCH_WAIT;
+
+        //Restarts the count
+        G8RTOS_GetTickMaxCycles();
+
+        for(uint32_t i = 0; i < sleepers[run]; ++i)
+        {
+            if(G8RTOS_AddThread(BenchSleeper, 0, STACK_CLASS_SMALL_WORDS, "SLEEPER") != NO_ERROR)
+            {
+                BackChannelPrintIntVariable("sleepBenchAddFailedAt", i);
+                return;
+            }
+        }
+
+        G8RTOS_SleepUntil(benchWakeTime + 2);
+
+        BackChannelPrintIntVariable("sleepBenchThreads", sleepers[run]);
+        BackChannelPrintIntVariable("sleepBenchTickMaxCycles", G8RTOS_GetTickMaxCycles());
+    }
+}
+#endif
+
+/*
+ * Returns the currently running threads ID
+ */
+threadID_t G8RTOS_GetThreadID(void)
+{
+    return CurrentlyRunningThread->threadID;
+}
+
+/*
+ * Initializes aperiodic registers
+ * param: Funtion pointer to serve as ISR
+ * param: Priority of thread
+ * param: IRQ interrupt number
+ */
+sched_ErrCode_t G8RTOS_AddAPeriodicEvent(void (*AthreadToAdd)(void), uint8_t priority,  IRQn_Type IRQn)
+{
+    int32_t priMask = StartCriticalSection();
+
+    //IF IRQn is less priority than last exception and greater priority than PORT6_IRQn
+    if((IRQn >PSS_IRQn) && (IRQn < PORT6_IRQn))
+    {
+        //If priority is lower than 6
+        if(priority >= 6)
+        {
+            __NVIC_SetVector(IRQn, (uint32_t)AthreadToAdd);
+            __NVIC_SetPriority(IRQn, priority);
+            __NVIC_EnableIRQ(IRQn);
+            EndCriticalSection(priMask);
+            return NO_ERROR;
+        }
+        EndCriticalSection(priMask);
+        return HWI_PRIORITY_INVALID;
+    }
+    EndCriticalSection(priMask);
+    return IRQn_INVALID;
+}
+
+/*
+ * Takes in a threadID for the thread to be Killed
+ *  param: ID of thread to be killed
+ */
+sched_ErrCode_t G8RTOS_KillThread(threadID_t threadID)
+{
+    int32_t priMask = StartCriticalSection();
+    G8RTOS_PROBE_START();
+
+    //Checks if only one thread running
+    if(NumberOfThreads == 1)
+    {
+        EndCriticalSection(priMask);
+        return CANNOT_KILL_LAST_THREAD;
+    }
+
+    //Looks thread up in the handle table
+    tcb_t *thread = FindThread(threadID);
+    if(!thread)
+    {
+        EndCriticalSection(priMask);
+        return THREAD_DOES_NOT_EXIST;
+    }
+
+    RemoveThread(thread);
+
+    //Time interrupts were masked for
+    G8RTOS_PROBE_END(PROBE_KILL_THREAD);
+
+    EndCriticalSection(priMask);
+
+    //If killed thread is currently running thread, yield CPU
+    if(thread == CurrentlyRunningThread)
+    {
+        SCB->ICSR |= (1<<28);
+    }
+
+    return NO_ERROR;
+}
+
+/*
+ * Kills currently running thread
+ */
+sched_ErrCode_t G8RTOS_KillSelf(void)
+{
+    int32_t priMask = StartCriticalSection();
+
+    //Checks if only one thread running
+    if(NumberOfThreads == 1)
+    {
+        EndCriticalSection(priMask);
+        return CANNOT_KILL_LAST_THREAD;
+    }
+
+    RemoveThread(CurrentlyRunningThread);
+
+    EndCriticalSection(priMask);
+
+    //Sets PendSV flag, to yield CPU
+    SCB->ICSR |= (1<<28);
+
+    return NO_ERROR;
+}
+
+/*
+ * Blocks until a thread ends (is killed or kills itself)
+ *  - Waits in the sleep queue for the timeout, it costs nothing while waiting
+ *  param threadID: ID of thread to wait for, a stale ID means the thread already ended
+ *  param timeout: ms to wait for, 0 to only check, WAIT_FOREVER to never time out
+ *
+ *  return: NO_ERROR once the thread ended, JOIN_TIMEOUT if it is still alive
+ */
+sched_ErrCode_t G8RTOS_JoinThread(threadID_t threadID, uint32_t timeout)
+{
+    int32_t priMask = StartCriticalSection();
+
+    tcb_t *thread = FindThread(threadID);
+
+    //Thread already ended
+    if(!thread)
+    {
+        EndCriticalSection(priMask);
+        return NO_ERROR;
+    }
+
+    if(thread == CurrentlyRunningThread)
+    {
+        EndCriticalSection(priMask);
+        return CANNOT_JOIN_SELF;
+    }
+
+    //Caller only checks
+    if(timeout == 0)
+    {
+        EndCriticalSection(priMask);
+        return JOIN_TIMEOUT;
+    }
+
+    //Blocks until RemoveThread wakes it or the timeout runs out
+    G8RTOS_WaitQueueInsertTimeout(&thread->joiners, CurrentlyRunningThread, timeout);
+
+    EndCriticalSection(priMask);
+
+    //Sets PendSV flag, to yield CPU
+    SCB->ICSR |= (1<<28);
+
+    //Runs again once woken up
+    return CurrentlyRunningThread->timedOut ? JOIN_TIMEOUT : NO_ERROR;
+}
+
+/*
+ * Stops a thread from being scheduled until it is resumed
+ *  - A sleeping or blocked thread still wakes up, but does not run until resumed
+ *  param: ID of thread to suspend
+ *
+ *  return: Returns error code
+ */
+sched_ErrCode_t G8RTOS_SuspendThread(threadID_t threadID)
 {
     int32_t priMask = StartCriticalSection();
 
-    //If number of periodic threads is not equal to maximum, then
-    if(NumberOfPthreads != MAXPTHREADS)
+    tcb_t *thread = FindThread(threadID);
+    if(!thread)
+    {
+        EndCriticalSection(priMask);
+        return THREAD_DOES_NOT_EXIST;
+    }
+
+    if(!thread->suspended)
     {
-        //If number of periodic threads
-        if(NumberOfPthreads == 0)
+        //Takes thread out of its ready list if it was in it
+        if(ThreadIsReady(thread))
         {
-            //Adds a new periodic thread to point to itself
-            Pthread[NumberOfPthreads].Handler = PthreadToAdd;
-            Pthread[NumberOfPthreads].period = period;
-            Pthread[NumberOfPthreads].currentTime = findCurrTime(period);
-            Pthread[NumberOfPthreads].executeTime = period + NumberOfPthreads;
-            Pthread[NumberOfPthreads].next = &Pthread[NumberOfPthreads];
-            Pthread[NumberOfPthreads].prev = &Pthread[NumberOfPthreads];
+            G8RTOS_ReadyRemove(thread);
         }
-        else
-        {
-            //Adds a new periodic thread to point to itself
-            Pthread[NumberOfPthreads].Handler = PthreadToAdd;
-            Pthread[NumberOfPthreads].period = period;
-            Pthread[NumberOfPthreads].currentTime = NumberOfPthreads;
-            Pthread[NumberOfPthreads].executeTime = period + NumberOfPthreads;
+        thread->suspended = true;
+    }
+
+    EndCriticalSection(priMask);
+
+    //If suspended thread is currently running thread, yield CPU
+    if(thread == CurrentlyRunningThread)
+    {
+        SCB->ICSR |= (1<<28);
+    }
+
+    return NO_ERROR;
+}
+
+/*
+ * Lets a suspended thread be scheduled again
+ *  param: ID of thread to resume
+ *
+ *  return: Returns error code
+ */
+sched_ErrCode_t G8RTOS_ResumeThread(threadID_t threadID)
+{
+    int32_t priMask = StartCriticalSection();
+
+    tcb_t *thread = FindThread(threadID);
+    if(!thread)
+    {
+        EndCriticalSection(priMask);
+        return THREAD_DOES_NOT_EXIST;
+    }
 
-            //Makes new periodic thread point to previous and head
-            Pthread[NumberOfPthreads].prev = &Pthread[NumberOfPthreads - 1];
-            Pthread[NumberOfPthreads].next = &Pthread[0];
+    if(thread->suspended)
+    {
+        thread->suspended = false;
 
-            //Makes previous root and head point to new periodic thread
-            Pthread[NumberOfPthreads - 1].next = &Pthread[NumberOfPthreads];
-            Pthread[0].prev = &Pthread[NumberOfPthreads];
+        //Puts thread back into its ready list if nothing else holds it
+        if(ThreadIsReady(thread))
+        {
+            G8RTOS_ReadyInsert(thread);
+            SCB->ICSR |= (1<<28);
         }
-        NumberOfPthreads++;
+    }
+
+    EndCriticalSection(priMask);
+    return NO_ERROR;
+}
+
+/*
+ * Changes the priority of a thread
+ *  - A thread holding a mutex keeps running at any higher priority it inherited
+ *  - EDF threads are ordered by deadline, not priority, so they are refused with THREAD_IS_EDF
+ *  param: ID of thread to change
+ *  param: new priority
+ *
+ *  return: Returns error code
+ */
+sched_ErrCode_t G8RTOS_SetPriority(threadID_t threadID, uint8_t priority)
+{
+    int32_t priMask = StartCriticalSection();
+
+    tcb_t *thread = FindThread(threadID);
+    if(!thread)
+    {
         EndCriticalSection(priMask);
-        return SUCCESS;
+        return THREAD_DOES_NOT_EXIST;
+    }
+
+    //Would leave it at a fixed priority while it still keeps EDF deadlines and skips time slicing
+    if(thread->edfPeriod)
+    {
+        EndCriticalSection(priMask);
+        return THREAD_IS_EDF;
     }
+
+    thread->basePriority = priority;
+    G8RTOS_MutexPriorityChanged(thread);
+
     EndCriticalSection(priMask);
-    //Returns 0 if more threads cannot be added
-    return THREAD_LIMIT_REACHED;
+
+    //Priority order may have changed
+    SCB->ICSR |= (1<<28);
+
+    return NO_ERROR;
 }
 
+/*
+ * Sets how many ticks threads of a priority run before the next ready thread of the same priority gets a turn
+ *  - Longer slices mean fewer context switches for CPU-heavy threads
+ *  - Every priority starts at DEFAULT_TIME_SLICE
+ *  param: priority level
+ *  param: ticks per slice, 1 to 255
+ *
+ *  return: Returns error code
+ */
+sched_ErrCode_t G8RTOS_SetTimeSlice(uint8_t priority, uint32_t ticks)
+{
+    if((ticks == 0) || (ticks > 255))
+    {
+        return TIME_SLICE_INVALID;
+    }
+
+    //Threads already in their slice keep what is left of it
+    sliceTicks[priority] = ticks;
+
+    return NO_ERROR;
+}
 
 /*
- * Puts the current thread into a sleep state.
- *  param durationMS: Duration of sleep time in ms
+ * Gives the rest of the current thread's time slice to the next ready thread of the same priority
+ *  - Returns right away if no other thread of its priority is ready
  */
-void G8RTOS_Sleep(uint32_t durationMS)
+void G8RTOS_Yield(void)
 {
-    //Initializes currently running threads sleep count
-    CurrentlyRunningThread->sleepCount = SystemTime + durationMS;
+    int32_t priMask = StartCriticalSection();
 
-    //Puts thread to sleep
-    CurrentlyRunningThread->asleep = true;
+    tcb_t *thread = CurrentlyRunningThread;
 
-    //Sets PendSV flag, to yield CPU
-    SCB->ICSR |= (1<<28);
+    //Moves to the back of its ready list with a fresh slice, EDF threads keep deadline order
+    if(!thread->edfPeriod && (readyList[thread->priority] == thread) && (thread->readyNext != thread))
+    {
+        readyList[thread->priority] = thread->readyNext;
+        thread->sliceLeft = sliceTicks[thread->priority];
+
+        EndCriticalSection(priMask);
+
+        //Sets PendSV flag, to yield CPU
+        SCB->ICSR |= (1<<28);
+        return;
+    }
+
+    EndCriticalSection(priMask);
 }
 
 /*
- * Returns the currently running threads ID
+ * Moves the current thread into the earliest-deadline-first class
+ *  - Thread runs at EDF_PRIORITY, among EDF threads the one with the earliest absolute deadline runs first
+ *  - Fixed priority threads above and below EDF_PRIORITY are scheduled as before
+ *  - First job is released now, the thread calls G8RTOS_WaitNextPeriod at the end of each job
+ *  param: period in ms
+ *  param: deadline in ms after each release, 1 to period
+ *
+ *  return: Returns error code
  */
-threadID_t G8RTOS_GetThreadID(void)
+sched_ErrCode_t G8RTOS_SetEDF(uint32_t period, uint32_t deadline)
 {
-    return CurrentlyRunningThread->threadID;
+    if((deadline == 0) || (deadline > period))
+    {
+        return DEADLINE_INVALID;
+    }
+
+    int32_t priMask = StartCriticalSection();
+
+    tcb_t *thread = CurrentlyRunningThread;
+
+    thread->edfPeriod = period;
+    thread->edfDeadline = deadline;
+    thread->edfRelease = SystemTime;
+    thread->absDeadline = SystemTime + deadline;
+    thread->edfKey = thread->absDeadline;
+
+    //Moves into the EDF ready list in deadline order
+    G8RTOS_ReadyRemove(thread);
+    thread->basePriority = EDF_PRIORITY;
+    thread->priority = EDF_PRIORITY;
+    G8RTOS_ReadyInsert(thread);
+
+    //Keeps any priority or deadline inherited from mutexes it owns
+    G8RTOS_MutexPriorityChanged(thread);
+
+    EndCriticalSection(priMask);
+
+    //An EDF thread due earlier may be waiting
+    SCB->ICSR |= (1<<28);
+
+    return NO_ERROR;
 }
 
 /*
- * Initializes aperiodic registers
- * param: Funtion pointer to serve as ISR
- * param: Priority of thread
- * param: IRQ interrupt number
+ * Ends the current EDF job and sleeps until the next release
+ *  - Counts a deadline miss if the job finished after its deadline
+ *  - Releases more than a period in the past are skipped, the thread restarts on the next one still to come
  */
-sched_ErrCode_t G8RTOS_AddAPeriodicEvent(void (*AthreadToAdd)(void), uint8_t priority,  IRQn_Type IRQn)
+void G8RTOS_WaitNextPeriod(void)
 {
     int32_t priMask = StartCriticalSection();
 
-    //IF IRQn is less priority than last exception and greater priority than PORT6_IRQn
-    if((IRQn >PSS_IRQn) && (IRQn < PORT6_IRQn))
+    tcb_t *thread = CurrentlyRunningThread;
+    uint32_t now = SystemTime;
+
+    thread->edfStats.jobs++;
+
+    //Finished after its deadline
+    if(TIME_BEFORE(thread->absDeadline, now))
     {
-        //If priority is lower than 6
-        if(priority >= 6)
+        uint32_t lateness = now - thread->absDeadline;
+
+        thread->edfStats.misses++;
+        if(lateness > thread->edfStats.maxLateness)
         {
-            __NVIC_SetVector(IRQn, (uint32_t)AthreadToAdd);
-            __NVIC_SetPriority(IRQn, priority);
-            __NVIC_EnableIRQ(IRQn);
-            return NO_ERROR;
+            thread->edfStats.maxLateness = lateness;
         }
+    }
+
+    //Next release, dropping any that are already a full period old
+    thread->edfRelease += thread->edfPeriod;
+    while(TIME_REACHED(now, thread->edfRelease + thread->edfPeriod))
+    {
+        thread->edfRelease += thread->edfPeriod;
+        thread->edfStats.skipped++;
+    }
+    thread->absDeadline = thread->edfRelease + thread->edfDeadline;
+
+    //Keeps any earlier deadline inherited from mutexes it still owns
+    thread->edfKey = thread->absDeadline;
+    G8RTOS_MutexPriorityChanged(thread);
+
+    //Release already passed, next job starts right away but takes its place by the new deadline
+    if(TIME_REACHED(now, thread->edfRelease))
+    {
+        G8RTOS_ReadyRemove(thread);
+        G8RTOS_ReadyInsert(thread);
+
         EndCriticalSection(priMask);
-        return HWI_PRIORITY_INVALID;
+
+        //An EDF thread due earlier may be waiting
+        SCB->ICSR |= (1<<28);
+        return;
     }
+
+    //Sleeps until the release, waking puts it into the EDF ready list by its new deadline
+    thread->asleep = true;
+    G8RTOS_TRACE_EVENT(TRACE_SLEEP, thread, thread->edfRelease - now);
+    G8RTOS_ReadyRemove(thread);
+    SleepQueueInsert(thread, thread->edfRelease - now);
+
     EndCriticalSection(priMask);
-    return IRQn_INVALID;
+
+    //Sets PendSV flag, to yield CPU
+    SCB->ICSR |= (1<<28);
 }
 
 /*
- * Takes in a threadID for the thread to be Killed
- *  param: ID of thread to be killed
+ * Copies the deadline statistics of an EDF thread
+ *  param: ID of thread
+ *  param: struct to fill
+ *
+ *  return: Returns error code
  */
-sched_ErrCode_t G8RTOS_KillThread(threadID_t threadID)
+sched_ErrCode_t G8RTOS_GetEDFStats(threadID_t threadID, edfStats_t *stats)
 {
     int32_t priMask = StartCriticalSection();
 
-    //Checks if only one thread running
-    if(NumberOfThreads == 1)
+    tcb_t *thread = FindThread(threadID);
+    if(!thread)
     {
         EndCriticalSection(priMask);
-        return CANNOT_KILL_LAST_THREAD;
+        return THREAD_DOES_NOT_EXIST;
     }
 
-    for(uint32_t i = 0; i < MAX_THREADS; ++i)
+    *stats = thread->edfStats;
+
+    EndCriticalSection(priMask);
+    return NO_ERROR;
+}
+
+/*
+ * Measures how much of a thread's stack has been used
+ *  - Stacks are painted at creation, the high-water mark is the deepest word overwritten
+ *  param: ID of thread to measure
+ *  param: struct to fill
+ *
+ *  return: Returns error code
+ */
+sched_ErrCode_t G8RTOS_GetStackUsage(threadID_t threadID, stackUsage_t *usage)
+{
+    int32_t priMask = StartCriticalSection();
+
+    tcb_t *thread = FindThread(threadID);
+    if(!thread)
     {
-        //If thread ID matches the one searched
-        if(threadID == threadControlBlocks[i].threadID)
-        {
-            //Kill thread
-            threadControlBlocks[i].isAlive = false;
+        EndCriticalSection(priMask);
+        return THREAD_DOES_NOT_EXIST;
+    }
 
-            uint32_t leftIndex = findLeftNode(i);
-            uint32_t rightIndex = findRightNode(i);
+    G8RTOS_StackMeasure(thread->stackBase, thread->stackSize, usage);
+
+    EndCriticalSection(priMask);
+    return NO_ERROR;
+}
 
-            threadControlBlocks[leftIndex].next = &threadControlBlocks[rightIndex];
-            threadControlBlocks[rightIndex].prev = &threadControlBlocks[leftIndex];
+/*
+ * Prints one line per thread to the back channel UART: name, stack used/size in words, percent used
+ *  - Flags stacks at STACK_WARN_PERCENT or more and stacks whose guard word was overwritten
+ */
+void G8RTOS_PrintStackUsage(void)
+{
+    char line[48];
+    char name[MAX_NAME_LENGTH];
+    stackUsage_t usage;
 
-            //Decreases number of new threads
-            NumberOfThreads--;
+    BackChannelPrint("thread          used/size   %", BackChannel_Info);
 
-            //If killed thread is currently running thread, then
-            if(&threadControlBlocks[i] == CurrentlyRunningThread)
-            {
-                EndCriticalSection(priMask);
-                //Sets PendSV flag, to yield CPU
-                SCB->ICSR |= (1<<28);
-            }
+    for(uint32_t i = 0; i < MAX_THREADS; ++i)
+    {
+        int32_t priMask = StartCriticalSection();
 
+        if(!threadControlBlocks[i].isAlive)
+        {
             EndCriticalSection(priMask);
-            return NO_ERROR;
+            continue;
         }
-    }
 
-    EndCriticalSection(priMask);
-    return THREAD_DOES_NOT_EXIST;
+        G8RTOS_StackMeasure(threadControlBlocks[i].stackBase, threadControlBlocks[i].stackSize, &usage);
+        strcpy(name, threadControlBlocks[i].threadName);
+
+        EndCriticalSection(priMask);
+
+        uint32_t percent = (usage.used * 100) / usage.size;
+        char *flag = "";
+        BackChannelTextStyle_t style = BackChannel_Info;
+
+        if(!usage.guardIntact)
+        {
+            flag = " OVERFLOW";
+            style = BackChannel_Error;
+        }
+        else if(percent >= STACK_WARN_PERCENT)
+        {
+            flag = " NEAR FULL";
+            style = BackChannel_Warning;
+        }
+
+        snprintf(line, sizeof(line), "%-15s %4u/%-4u %3u%s",
+                 name, (unsigned)usage.used, (unsigned)usage.size, (unsigned)percent, flag);
+        BackChannelPrint(line, style);
+    }
 }
 
 /*
- * Kills currently running thread
+ * Copies the CPU usage of a thread
+ *  param: ID of thread
+ *  param: struct to fill
+ *
+ *  return: Returns error code
  */
-sched_ErrCode_t G8RTOS_KillSelf(void)
+sched_ErrCode_t G8RTOS_GetThreadStats(threadID_t threadID, threadStats_t *stats)
 {
     int32_t priMask = StartCriticalSection();
 
-    //Checks if only one thread running
-    if(NumberOfThreads == 1)
+    tcb_t *thread = FindThread(threadID);
+    if(!thread)
     {
         EndCriticalSection(priMask);
-        return CANNOT_KILL_LAST_THREAD;
+        return THREAD_DOES_NOT_EXIST;
     }
 
-    //Kills thread
-    CurrentlyRunningThread->isAlive = false;
+    stats->threadID = thread->threadID;
+    strcpy(stats->name, thread->threadName);
+    stats->priority = thread->priority;
+    stats->runCycles = thread->runCycles;
+    stats->blockedCycles = thread->blockedCycles;
+    stats->switchesIn = thread->switchesIn;
+    stats->deadlineMisses = thread->edfStats.misses;
 
-    //Sets previous thread's next to current's next
-    CurrentlyRunningThread->prev->next = CurrentlyRunningThread->next;
+    //Running thread has not been charged for its current run yet
+    if(thread == CurrentlyRunningThread)
+    {
+        stats->runCycles += DWT->CYCCNT - lastSwitchCycles;
+    }
 
-    //Sets next thread's previous to current's previous
-    CurrentlyRunningThread->next->prev = CurrentlyRunningThread->prev;
+    EndCriticalSection(priMask);
+    return NO_ERROR;
+}
 
-    //Decreases number of new threads
-    NumberOfThreads--;
+/*
+ * Prints a top-style table to the back channel UART, covering the time since the last call
+ *  - One line per thread: name, priority, CPU percent, switches in, ms spent blocked, EDF deadline misses (total)
+ *  - Then the percent of time spent in the thread that calls G8RTOS_Idle, and context switches per second
+ */
+void G8RTOS_PrintThreadStats(void)
+{
+    char line[64];
+    char name[MAX_NAME_LENGTH];
 
+    //Cycles covered by this report
+    int32_t priMask = StartCriticalSection();
+    uint32_t now = DWT->CYCCNT;
+    uint32_t total = now - lastReportCycles;
+    lastReportCycles = now;
     EndCriticalSection(priMask);
 
-    return NO_ERROR;
+    //Nothing to report yet
+    if(total == 0)
+    {
+        return;
+    }
+
+    uint32_t idleTenths = 0;
+    uint32_t totalSwitches = 0;
+
+    BackChannelPrint("thread          pri   cpu%  switch  blockms  miss", BackChannel_Info);
+
+    for(uint32_t i = 0; i < MAX_THREADS; ++i)
+    {
+        tcb_t *thread = &threadControlBlocks[i];
+
+        priMask = StartCriticalSection();
+
+        if(!thread->isAlive)
+        {
+            EndCriticalSection(priMask);
+            continue;
+        }
+
+        //Charges the running thread (this one) up to now
+        if(thread == CurrentlyRunningThread)
+        {
+            uint32_t cycles = DWT->CYCCNT;
+            thread->runCycles += cycles - lastSwitchCycles;
+            lastSwitchCycles = cycles;
+        }
+
+        uint64_t run = thread->runCycles - thread->reportRunCycles;
+        uint64_t blocked = thread->blockedCycles - thread->reportBlockedCycles;
+        uint32_t switches = thread->switchesIn - thread->reportSwitchesIn;
+        uint32_t misses = thread->edfStats.misses;
+        uint8_t priority = thread->priority;
+        bool isIdle = (thread == idleThread);
+        strcpy(name, thread->threadName);
+
+        thread->reportRunCycles = thread->runCycles;
+        thread->reportBlockedCycles = thread->blockedCycles;
+        thread->reportSwitchesIn = thread->switchesIn;
+
+        EndCriticalSection(priMask);
+
+        //Percent with one decimal, in tenths
+        uint32_t tenths = (uint32_t)((run * 1000) / total);
+        if(isIdle)
+        {
+            idleTenths = tenths;
+        }
+        totalSwitches += switches;
+
+        snprintf(line, sizeof(line), "%-15s %3u %4u.%u %7u %8u %5u",
+                 name, (unsigned)priority, (unsigned)(tenths / 10), (unsigned)(tenths % 10),
+                 (unsigned)switches, (unsigned)(blocked / cyclesPerTick), (unsigned)misses);
+        BackChannelPrint(line, BackChannel_Info);
+    }
+
+    BackChannelPrintIntVariable("idlePercent", idleTenths / 10);
+    BackChannelPrintIntVariable("switchesPerSecond", (int32_t)(((uint64_t)totalSwitches * cyclesPerTick * 1000) / total));
 }
+
 /*********************************************** Public Functions *********************************************************************/
@@ -5,21 +5,256 @@
 #define G8RTOS_SCHEDULER_H_
 
 /*********************************************** Sizes and Limits *********************************************************************/
-#define MAX_THREADS 23
+#define MAX_THREADS (23 + KERNEL_THREADS)
+#ifndef MAXPTHREADS
 #define MAXPTHREADS 6
+#endif
 #define MAXBALLS 20
-#define STACKSIZE 512
+#define MAX_NAME_LENGTH 16 //Chars a thread name holds, including the terminator
+#define STACKSIZE 512 //Stack size in words every thread used to get, the stack pool report compares against it
 #define OSINT_PRIORITY 7
+#define MAX_PRIORITIES 256
+#define DEFAULT_TIME_SLICE 1 //Ticks a thread runs before the next thread of its priority gets a turn
+#define EDF_PRIORITY 130 //Priority level of the EDF class, its ready list is ordered by deadline
 /*********************************************** Sizes and Limits *********************************************************************/
 
+/*********************************************** Kernel Options ***********************************************************************/
+
+/*
+ * Tickless idle
+ *  - 1: SysTick is reprogrammed to the next deadline while only the idle thread can run
+ *  - 0: SysTick interrupts every 1ms
+ */
+#ifndef G8RTOS_TICKLESS
+#define G8RTOS_TICKLESS 0
+#endif
+
+/*
+ * Deferred periodic events
+ *  - 1: SysTick only marks periodic events as due, a kernel worker thread runs their handlers
+ *       (handlers may then block, wait on semaphores and use the I2C driver)
+ *  - 0: handlers run inside SysTick_Handler
+ */
+#ifndef G8RTOS_DEFERRED_PERIODIC
+#define G8RTOS_DEFERRED_PERIODIC 0
+#endif
+
+/* Priority of the periodic event worker thread */
+#define PERIODIC_WORKER_PRIORITY 0
+
+/*
+ * Kernel monitor
+ *  - 1: a low priority kernel thread prints the stack usage table (G8RTOS_PrintStackUsage)
+ *       the CPU usage table (G8RTOS_PrintThreadStats) and the context switch timing (G8RTOS_PrintSwitchStats)
+ *       to the back channel UART every MONITOR_PERIOD ms, with G8RTOS_TICKLESS also the idle statistics (G8RTOS_PrintIdleStats)
+ *  - 0: tables are only printed when the application calls those functions
+ */
+#ifndef G8RTOS_MONITOR
+#define G8RTOS_MONITOR 1
+#endif
+
+/* Priority and period of the monitor thread */
+#define MONITOR_PRIORITY 254
+#define MONITOR_PERIOD 1000
+
+/*
+ * Kernel event trace
+ *  - 1: context switches, semaphore waits and signals, sleeps and wake ups, ISR entry and exit
+ *       and FIFO reads and writes are recorded in a ring of TRACE_BUFFER_SIZE 8-byte records,
+ *       drained with G8RTOS_TraceDump and converted with tools/trace2chrome.py
+ *  - 0: trace points compile to nothing
+ */
+#ifndef G8RTOS_TRACE
+#define G8RTOS_TRACE 0
+#endif
+
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE 512
+#endif
+
+/* ms between trace dumps by the monitor thread, without G8RTOS_MONITOR the application calls G8RTOS_TraceDump */
+#ifndef TRACE_DUMP_PERIOD
+#define TRACE_DUMP_PERIOD 10000
+#endif
+
+/*
+ * Software timers
+ *  - 1: a kernel timer thread calls the callbacks of expired software timers (G8RTOS_Timer.h)
+ *  - 0: no timer thread, software timers cannot be used
+ */
+#ifndef G8RTOS_TIMERS
+#define G8RTOS_TIMERS 1
+#endif
+
+/* Priority of the timer thread, above the application's threads so callbacks run on time */
+#define TIMER_THREAD_PRIORITY 100
+
+/*
+ * Kernel path instrumentation
+ *  - 1: SysTick, PendSV, interrupt latency and the probed kernel functions record min, max and a histogram
+ *       of their clock cycles per site (G8RTOS_Instrument.h), printed with G8RTOS_PrintProbeReport
+ *  - 0: probes compile to nothing
+ */
+#ifndef G8RTOS_INSTRUMENT
+#define G8RTOS_INSTRUMENT 0
+#endif
+
+/*
+ * Interrupt latency probe
+ *  - 1: G8RTOS_Init starts the Timer32 2 latency probe (G8RTOS_Latency.h) at LATENCY_PROBE_PRIORITY
+ *       and the monitor thread prints its statistics, so builds with G8RTOS_CS_PRIMASK 0 and 1 can be compared
+ *  - 0: Timer32 2 is left to the application
+ */
+#ifndef G8RTOS_LATENCY_PROBE
+#define G8RTOS_LATENCY_PROBE 0
+#endif
+
+/* NVIC priority of the probe interrupt, 0 is the priority the I2C interrupt runs at */
+#define LATENCY_PROBE_PRIORITY 0
+
+/*
+ * High resolution time
+ *  - 1: Timer32 1 keeps a 64-bit us timebase (G8RTOS_GetTimeUs) and Timer_A1 wakes threads sleeping
+ *       in G8RTOS_SleepUs (G8RTOS_Time.h)
+ *  - 0: SystemTime in ms is the only time, both timers are left to the application
+ */
+#ifndef G8RTOS_HIRES_TIME
+#define G8RTOS_HIRES_TIME 1
+#endif
+
+/*
+ * Scheduler benchmarks
+ *  - 1: G8RTOS_SchedulerBenchmark and G8RTOS_SleepBenchmark are built, the first keeps
+ *       SCHED_BENCH_MAX_THREADS synthetic TCBs and a copy of the ready lists in RAM,
+ *       the demo runs them once from its BENCH thread (threads.h)
+ *  - 0: no benchmarks
+ */
+#ifndef G8RTOS_SCHED_BENCHMARK
+#define G8RTOS_SCHED_BENCHMARK 0
+#endif
+
+/* Most synthetic threads G8RTOS_SchedulerBenchmark fills the ready lists with, and scheduler calls it times */
+#define SCHED_BENCH_MAX_THREADS 64
+#define SCHED_BENCH_ITERATIONS 1000
+
+/* ms G8RTOS_SleepBenchmark's threads sleep for, every one wakes on the same tick */
+#define SLEEP_BENCH_WAIT 50
+
+/* Threads the kernel adds for itself, counted on top of the application's threads */
+#define KERNEL_THREADS (G8RTOS_DEFERRED_PERIODIC + G8RTOS_MONITOR + G8RTOS_TIMERS)
+
+/*********************************************** Kernel Options ***********************************************************************/
+
 /*********************************************** Public Variables *********************************************************************/
 
 /* Holds the current time for the whole System */
 extern uint32_t SystemTime;
 
+/* Compares SystemTime values so results stay correct when SystemTime wraps */
+#define TIME_BEFORE(a, b) ((int32_t)((a) - (b)) < 0)
+#define TIME_REACHED(now, time) ((int32_t)((now) - (time)) >= 0)
+
 /*********************************************** Public Variables *********************************************************************/
+/*
+ * Thread ID typedef
+ *  - Low byte is the thread's slot in the handle table, upper bits count how many threads used that slot
+ *  - IDs of killed threads are rejected, even once their slot is reused
+ */
 typedef uint32_t threadID_t;
 
+/*
+ * What a periodic event does when it is released late by more than one period
+ *  - PERIODIC_CATCH_UP: runs once for every missed release, back to back
+ *  - PERIODIC_SKIP: runs once and moves to the next release that has not passed
+ */
+typedef enum
+{
+    PERIODIC_CATCH_UP = 0,
+    PERIODIC_SKIP     = 1
+}periodicPolicy_t;
+
+/*
+ * Periodic event statistics, lateness is measured in ms from the release time
+ */
+typedef struct periodicStats_t
+{
+    uint32_t releases; //Holds number of times the handler ran
+    uint32_t skipped; //Holds number of releases dropped by PERIODIC_SKIP
+    uint32_t maxLateness; //Holds most a release ran after its release time
+    uint32_t maxJitter; //Holds largest change in lateness between two releases
+    uint32_t lastLateness; //Holds lateness of the last release
+}periodicStats_t;
+
+/*
+ * Idle statistics, counted since the last call to G8RTOS_GetIdleStats
+ */
+typedef struct idleStats_t
+{
+    uint32_t elapsedMS; //Holds system time passed
+    uint32_t tickInterrupts; //Holds number of SysTick interrupts taken
+    uint32_t wakeups; //Holds number of times the CPU woke up from idle (WFI)
+    uint64_t idleCycles; //Holds clock cycles the CPU spent asleep in idle
+}idleStats_t;
+
+/*
+ * Stack usage of a thread, sizes are in words
+ */
+typedef struct stackUsage_t
+{
+    uint32_t size; //Holds size of the thread's stack
+    uint32_t used; //Holds most of the stack ever used (high-water mark)
+    bool guardIntact; //False once the stack has overflowed
+}stackUsage_t;
+
+/*
+ * Kinds of context switch, by whether the old and new threads use the FPU
+ *  - A thread uses the FPU once it has run a floating point instruction, its S16-S31 are then saved on switches
+ *  - Values match the index PendSV_Handler builds from the two EXC_RETURN values
+ */
+typedef enum
+{
+    SWITCH_FPU_TO_FPU = 0,
+    SWITCH_FPU_TO_INT = 1,
+    SWITCH_INT_TO_FPU = 2,
+    SWITCH_INT_TO_INT = 3,
+    NUMBER_OF_SWITCH_KINDS = 4
+}switchKind_t;
+
+/*
+ * Context switch timing, in clock cycles from PendSV_Handler entry to exit
+ */
+typedef struct switchStats_t
+{
+    uint32_t lastCycles; //Holds length of the last switch
+    uint32_t maxCycles; //Holds length of the longest switch
+}switchStats_t;
+
+/*
+ * CPU usage of a thread since it was added, times are in clock cycles
+ *  - Time spent in interrupts is charged to the thread they interrupted
+ */
+typedef struct threadStats_t
+{
+    threadID_t threadID; //Holds ID of the thread
+    char name[MAX_NAME_LENGTH]; //Holds thread name
+    uint8_t priority; //Holds current priority
+    uint64_t runCycles; //Holds time spent running
+    uint64_t blockedCycles; //Holds time spent blocked on semaphores, mutexes and event groups
+    uint32_t switchesIn; //Holds number of times it was switched to
+    uint32_t deadlineMisses; //Holds EDF jobs that finished after their deadline
+}threadStats_t;
+
+/*
+ * Deadline statistics of an EDF thread, times are in ms
+ */
+typedef struct edfStats_t
+{
+    uint32_t jobs; //Holds number of jobs finished
+    uint32_t misses; //Holds jobs that finished after their deadline
+    uint32_t skipped; //Holds releases dropped because the thread fell more than a period behind
+    uint32_t maxLateness; //Holds most a job finished after its deadline
+}edfStats_t;
+
 /*
  * Error Codes for Scheduler
  */
@@ -32,7 +267,14 @@ typedef enum
     THREAD_DOES_NOT_EXIST     = -4,
     CANNOT_KILL_LAST_THREAD   = -5,
     IRQn_INVALID              = -6,
-    HWI_PRIORITY_INVALID      = -7
+    HWI_PRIORITY_INVALID      = -7,
+    PERIOD_INVALID            = -8,
+    MUTEX_NOT_OWNER           = -9,
+    TIME_SLICE_INVALID        = -10,
+    DEADLINE_INVALID          = -11,
+    JOIN_TIMEOUT              = -12,
+    CANNOT_JOIN_SELF          = -13,
+    THREAD_IS_EDF             = -14
 }sched_ErrCode_t;
 /*********************************************** Public Functions *********************************************************************/
 
@@ -53,29 +295,114 @@ int32_t G8RTOS_Launch();
  * Adds threads to G8RTOS Scheduler
  * 	- Checks if there are stil available threads to insert to scheduler
  * 	- Initializes the thread control block for the provided thread
+ * 	- Takes a stack from the smallest stack pool class that holds stackSize
  * 	- Initializes the stack for the provided thread
- * 	- Sets up the next and previous tcb pointers in a round robin fashion
+ * 	- Adds the thread to the ready list of its priority
  * Param "threadToAdd": Void-Void Function to add as preemptable main thread
- * Returns: Error code for adding threads
+ * Param "priority": specified priority of new thread
+ * Param "stackSize": stack size needed by the thread, in words
+ * Param "name": Name given to thread
+ * Returns: Error code for adding threads, ERROR if no slot or stack is free
  */
-int32_t G8RTOS_AddThread(void (*threadToAdd)(void), uint8_t priority, char* name);
+int32_t G8RTOS_AddThread(void (*threadToAdd)(void), uint8_t priority, uint32_t stackSize, char* name);
 
 /*
  * Adds periodic threads to G8RTOS Scheduler
  * Function will initialize a periodic event struct to represent event.
- * The struct will be added to a linked list of periodic events
+ * The struct will be added to the min-heap of periodic events
+ * Events are offset by 1ms from each other so they do not all run on the same tick
+ * Late releases are skipped (PERIODIC_SKIP)
  * Param Pthread To Add: void-void function for P thread handler
  * Param period: period of P thread to add
  * Returns: Error code for adding threads
  */
 int G8RTOS_AddPeriodicEvent(void (*PthreadToAdd)(void), uint32_t period);
 
+/*
+ * Adds periodic threads to G8RTOS Scheduler with a chosen phase and late release policy
+ * Param Pthread To Add: void-void function for P thread handler
+ * Param period: period of P thread to add in ms
+ * Param phase: extra delay in ms before the first release
+ * Param policy: what to do with missed releases
+ * Returns: Error code for adding threads
+ */
+int G8RTOS_AddPeriodicEventPolicy(void (*PthreadToAdd)(void), uint32_t period, uint32_t phase, periodicPolicy_t policy);
+
+/*
+ * Copies the statistics of a periodic event
+ * Param PthreadToFind: handler the event was added with
+ * Param stats: struct to fill
+ * Returns: Error code, THREAD_DOES_NOT_EXIST if no event uses that handler
+ */
+sched_ErrCode_t G8RTOS_GetPeriodicStats(void (*PthreadToFind)(void), periodicStats_t *stats);
+
 /*
  * Puts the current thread into a sleep state.
  *  param durationMS: Duration of sleep time in ms
  */
 void G8RTOS_Sleep(uint32_t durationMS);
 
+/*
+ * Puts the current thread into a sleep state until an absolute system time.
+ * Used by periodic loops so their period does not drift with the time spent working.
+ *  param wakeTime: SystemTime (in ms) to wake up at, returns at once if it has already passed
+ */
+void G8RTOS_SleepUntil(uint32_t wakeTime);
+
+/*
+ * Returns the most clock cycles a single SysTick_Handler has taken since the last call, then restarts counting
+ */
+uint32_t G8RTOS_GetTickMaxCycles(void);
+
+/*
+ * Called in a loop by the idle thread
+ *  - With G8RTOS_TICKLESS, stops the tick until the next sleep or periodic deadline and puts the CPU in LPM0 (WFI)
+ *  - Without G8RTOS_TICKLESS, returns right away
+ */
+void G8RTOS_Idle(void);
+
+/*
+ * Copies idle statistics counted since the last call, then restarts counting
+ *  param stats: struct to fill
+ */
+void G8RTOS_GetIdleStats(idleStats_t *stats);
+
+/*
+ * Prints wakeups per second and idle residency (percent of time asleep) to the back channel UART
+ * Restarts counting like G8RTOS_GetIdleStats
+ */
+void G8RTOS_PrintIdleStats(void);
+
+/*
+ * Copies context switch timing for every kind of switch, indexed by switchKind_t
+ *  param stats: array of NUMBER_OF_SWITCH_KINDS structs to fill
+ */
+void G8RTOS_GetSwitchStats(switchStats_t *stats);
+
+/*
+ * Prints last and longest context switch, in cycles, for every kind of switch to the back channel UART
+ */
+void G8RTOS_PrintSwitchStats(void);
+
+#if G8RTOS_SCHED_BENCHMARK
+/*
+ * Times G8RTOS_Scheduler against the linear scan it replaced and prints both to the back channel UART
+ *  - Fills the ready lists with synthetic threads, MAX_THREADS caps real ones, then puts the real ready lists back
+ *  - Runs with every interrupt masked, the pick of each call is the same thread so no switch is recorded
+ *  - Meant to be run with 4, 23 and 64 threads
+ *  param threads: number of synthetic threads, at most SCHED_BENCH_MAX_THREADS
+ */
+void G8RTOS_SchedulerBenchmark(uint32_t threads);
+
+/*
+ * Prints the longest SysTick_Handler, in cycles, with 0, 5, 10 and 20 threads asleep to the back channel UART
+ *  - Each run adds that many threads that sleep SLEEP_BENCH_WAIT ms, wake up on the same tick and kill themselves
+ *  - Must be called from a thread, needs 20 free thread slots and small stacks
+ *  - Uses G8RTOS_GetTickMaxCycles, so it restarts that count
+ */
+void G8RTOS_SleepBenchmark(void);
+#endif
+
 /*
  * Returns currently running threads ID
  */
@@ -106,6 +433,121 @@ sched_ErrCode_t G8RTOS_KillThread(threadID_t threadID);
  */
 sched_ErrCode_t G8RTOS_KillSelf(void);
 
+/*
+ * Blocks until a thread ends (is killed or kills itself)
+ *  - Waits in the sleep queue for the timeout, it costs nothing while waiting
+ *  param threadID: ID of thread to wait for, a stale ID means the thread already ended
+ *  param timeout: ms to wait for, 0 to only check, WAIT_FOREVER to never time out
+ *
+ *  return: NO_ERROR once the thread ended, JOIN_TIMEOUT if it is still alive
+ */
+sched_ErrCode_t G8RTOS_JoinThread(threadID_t threadID, uint32_t timeout);
+
+/*
+ * Stops a thread from being scheduled until it is resumed
+ *  - A sleeping or blocked thread still wakes up, but does not run until resumed
+ *  param: ID of thread to suspend
+ *
+ *  return: Returns error code
+ */
+sched_ErrCode_t G8RTOS_SuspendThread(threadID_t threadID);
+
+/*
+ * Lets a suspended thread be scheduled again
+ *  param: ID of thread to resume
+ *
+ *  return: Returns error code
+ */
+sched_ErrCode_t G8RTOS_ResumeThread(threadID_t threadID);
+
+/*
+ * Changes the priority of a thread
+ *  - A thread holding a mutex keeps running at any higher priority it inherited
+ *  - EDF threads are ordered by deadline, not priority, so they are refused with THREAD_IS_EDF
+ *  param: ID of thread to change
+ *  param: new priority
+ *
+ *  return: Returns error code
+ */
+sched_ErrCode_t G8RTOS_SetPriority(threadID_t threadID, uint8_t priority);
+
+/*
+ * Sets how many ticks threads of a priority run before the next ready thread of the same priority gets a turn
+ *  - Longer slices mean fewer context switches for CPU-heavy threads
+ *  - Every priority starts at DEFAULT_TIME_SLICE
+ *  param: priority level
+ *  param: ticks per slice, 1 to 255
+ *
+ *  return: Returns error code
+ */
+sched_ErrCode_t G8RTOS_SetTimeSlice(uint8_t priority, uint32_t ticks);
+
+/*
+ * Gives the rest of the current thread's time slice to the next ready thread of the same priority
+ *  - Returns right away if no other thread of its priority is ready
+ */
+void G8RTOS_Yield(void);
+
+/*
+ * Moves the current thread into the earliest-deadline-first class
+ *  - Thread runs at EDF_PRIORITY, among EDF threads the one with the earliest absolute deadline runs first
+ *  - Fixed priority threads above and below EDF_PRIORITY are scheduled as before
+ *  - First job is released now, the thread calls G8RTOS_WaitNextPeriod at the end of each job
+ *  param: period in ms
+ *  param: deadline in ms after each release, 1 to period
+ *
+ *  return: Returns error code
+ */
+sched_ErrCode_t G8RTOS_SetEDF(uint32_t period, uint32_t deadline);
+
+/*
+ * Ends the current EDF job and sleeps until the next release
+ *  - Counts a deadline miss if the job finished after its deadline
+ *  - Releases more than a period in the past are skipped, the thread restarts on the next one still to come
+ */
+void G8RTOS_WaitNextPeriod(void);
+
+/*
+ * Copies the deadline statistics of an EDF thread
+ *  param: ID of thread
+ *  param: struct to fill
+ *
+ *  return: Returns error code
+ */
+sched_ErrCode_t G8RTOS_GetEDFStats(threadID_t threadID, edfStats_t *stats);
+
+/*
+ * Measures how much of a thread's stack has been used
+ *  - Stacks are painted at creation, the high-water mark is the deepest word overwritten
+ *  param: ID of thread to measure
+ *  param: struct to fill
+ *
+ *  return: Returns error code
+ */
+sched_ErrCode_t G8RTOS_GetStackUsage(threadID_t threadID, stackUsage_t *usage);
+
+/*
+ * Prints one line per thread to the back channel UART: name, stack used/size in words, percent used
+ *  - Flags stacks at STACK_WARN_PERCENT or more and stacks whose guard word was overwritten
+ */
+void G8RTOS_PrintStackUsage(void);
+
+/*
+ * Copies the CPU usage of a thread
+ *  param: ID of thread
+ *  param: struct to fill
+ *
+ *  return: Returns error code
+ */
+sched_ErrCode_t G8RTOS_GetThreadStats(threadID_t threadID, threadStats_t *stats);
+
+/*
+ * Prints a top-style table to the back channel UART, covering the time since the last call
+ *  - One line per thread: name, priority, CPU percent, switches in, ms spent blocked, EDF deadline misses (total)
+ *  - Then the percent of time spent in the thread that calls G8RTOS_Idle, and context switches per second
+ */
+void G8RTOS_PrintThreadStats(void);
+
 /*********************************************** Public Functions *********************************************************************/
 
 #endif /* G8RTOS_SCHEDULER_H_ */
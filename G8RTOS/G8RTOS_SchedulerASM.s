@@ -6,7 +6,7 @@
 	.def G8RTOS_Start, PendSV_Handler
 
 	; Dependencies
-	.ref CurrentlyRunningThread, G8RTOS_Scheduler
+	.ref CurrentlyRunningThread, G8RTOS_Scheduler, contextSwitchStats, lastPendSVCycles
 
 	.thumb		; Set to thumb mode
 	.align 2	; Align by 2 bytes (thumb mode uses allignment by 2 or 4)
@@ -15,6 +15,14 @@
 ; Need to have the address defined in file 
 ; (label needs to be close enough to asm code to be reached with PC relative addressing)
 RunningPtr: .field CurrentlyRunningThread, 32
+SwitchStatsPtr: .field contextSwitchStats, 32
+LastPendSVPtr: .field lastPendSVCycles, 32
+
+; DWT cycle counter, started in G8RTOS_Init
+DwtCycCnt: .field 0xE0001004, 32
+
+; BASEPRI value the switch masks interrupts with, must match KERNEL_IRQ_PRIORITY in G8RTOS_CriticalSection.h
+KERNEL_BASEPRI .set 0x20
 
 ; G8RTOS_Start
 ;	Sets the first thread to be the currently running thread
@@ -23,6 +31,10 @@ G8RTOS_Start:
 
 	.asmfunc
 
+	;Threads start with nothing masked by BASEPRI
+	mov r0, #0
+	msr basepri, r0
+
 	;Gets the SP from RunningPtr(**CurrentlyRunningThread)
 	ldr r4, RunningPtr
 	ldr r5, [r4,#0]
@@ -30,6 +42,10 @@ G8RTOS_Start:
 
 	;Pops registers
 	pop {R4-R11}
+
+	;Skips EXC_RETURN, first thread is not started by an exception return
+	add sp, sp, #4
+
 	pop {R0-R3}
 	pop {R12}
 	pop {LR}
@@ -46,45 +62,85 @@ G8RTOS_Start:
 
 ; PendSV_Handler
 ; - Performs a context switch in G8RTOS
-; 	- Saves remaining registers into thread stack
+;	- Saves S16-S31 only if the thread used the FPU (EXC_RETURN bit 4 clear),
+;	  the hardware already reserved room for S0-S15 and saves them lazily
+; 	- Saves remaining registers and EXC_RETURN into thread stack
 ;	- Saves current stack pointer to tcb
 ;	- Calls G8RTOS_Scheduler to get new tcb
 ;	- Set stack pointer to new stack pointer from new tcb
-;	- Pops registers from thread stack
+;	- Pops registers from thread stack, and S16-S31 if the new thread used the FPU
+;	- Records the switch's cycle count in contextSwitchStats[switchKind_t] and lastPendSVCycles
+;	- Masks interrupts with BASEPRI, interrupts above KERNEL_IRQ_PRIORITY still run during the switch
 PendSV_Handler:
 	
 	.asmfunc
 
-	;Disables interrupts
-	CPSID I
+	;Masks interrupts the kernel can be called from, higher ones (I2C) still run
+	mov r0, #KERNEL_BASEPRI
+	msr basepri, r0
+	isb
+
+	;Cycle count at entry (R0-R3 were saved by the hardware)
+	ldr r0, DwtCycCnt
+	ldr r1, [r0]
 
-	;Saves registers
-	push {R4-R11}
+	;Saves FPU registers of threads that used the FPU
+	tst lr, #0x10
+	it eq
+	vpusheq {S16-S31}
+
+	;Saves registers and EXC_RETURN
+	push {R4-R11, LR}
 
 	;Stores current stack pointer to TCB
 	ldr r4, RunningPtr
 	ldr r5, [r4,#0]
 	str sp, [r5,#0]
 
-	;pushes LR
-	push {LR}
+	;Keeps entry cycle count and old EXC_RETURN across the call
+	mov r6, r1
+	mov r7, lr
 
 	;Updates currently running thread
 	BL G8RTOS_Scheduler
 
-	;Pops LR
-	pop {LR}
-
 	;Loads new SP
 	ldr r4, RunningPtr
 	ldr r5, [r4,#0]
 	ldr sp, [r5,#0]
 
-	;Restores resgisters
-	pop {R4-R11}
-
-	;Enables interrupts
-	CPSIE I
+	;Switch kind = (old EXC_RETURN bit 4 << 1) | new EXC_RETURN bit 4
+	ldr r2, [sp, #32]
+	ubfx r3, r7, #4, #1
+	ubfx r0, r2, #4, #1
+	orr r0, r0, r3, lsl #1
+	mov r1, r6
+
+	;Restores registers and EXC_RETURN
+	pop {R4-R11, LR}
+
+	;Restores FPU registers of threads that used the FPU
+	tst lr, #0x10
+	it eq
+	vpopeq {S16-S31}
+
+	;Records cycles taken by the switch
+	ldr r2, DwtCycCnt
+	ldr r2, [r2]
+	sub r2, r2, r1
+	ldr r3, SwitchStatsPtr
+	add r3, r3, r0, lsl #3
+	str r2, [r3, #0]
+	ldr r0, [r3, #4]
+	cmp r2, r0
+	it hi
+	strhi r2, [r3, #4]
+	ldr r3, LastPendSVPtr
+	str r2, [r3]
+
+	;Unmasks interrupts, PendSV only runs once no thread held BASEPRI
+	mov r0, #0
+	msr basepri, r0
 
 	;Returns
 	bx LR
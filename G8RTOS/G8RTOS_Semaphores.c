@@ -13,18 +13,35 @@ extern tcb_t * CurrentlyRunningThread;
 /*********************************************** Public Functions *********************************************************************/
 
 /*
- * Initializes a semaphore to a given value
+ * Initializes a semaphore to a given value, waiting threads wake up in FIFO order
  * Param "s": Pointer to semaphore
  * Param "value": Value to initialize semaphore to
  * THIS IS A CRITICAL SECTION
  */
 void G8RTOS_InitSemaphore(semaphore_t *s, int32_t value)
+{
+    G8RTOS_InitSemaphoreOrder(s, value, WAIT_FIFO);
+}
+
+/*
+ * Initializes a semaphore to a given value with a chosen wake up order
+ * Param "s": Pointer to semaphore
+ * Param "value": Value to initialize semaphore to
+ * Param "order": WAIT_FIFO or WAIT_PRIORITY
+ * THIS IS A CRITICAL SECTION
+ */
+void G8RTOS_InitSemaphoreOrder(semaphore_t *s, int32_t value, waitOrder_t order)
 {
     //Disables interrupts
     int32_t priMask = StartCriticalSection();
 
-    //Initialize semaphore
-    *s = value;
+    //Initialize semaphore with no waiting threads
+    s->value = value;
+    s->waiters.head = 0;
+    s->waiters.tail = 0;
+    s->waiters.order = order;
+    s->waiters.stats.waits = 0;
+    s->waiters.stats.blockedCycles = 0;
 
     //Enable interrupts
     EndCriticalSection(priMask);
@@ -32,8 +49,8 @@ void G8RTOS_InitSemaphore(semaphore_t *s, int32_t value)
 
 /*
  * No longer waits for semaphore
- *  - Decrements semaphore
- *  - Blocks thread is semaphore is unavailable
+ *  - Decrements semaphore if it is available
+ *  - Blocks thread in the semaphore's wait queue if it is unavailable
  * Param "s": Pointer to semaphore to wait on
  * THIS IS A CRITICAL SECTION
  */
@@ -42,14 +59,20 @@ void G8RTOS_WaitSemaphore(semaphore_t *s)
     //Disable Interrupts
     int32_t priMask = StartCriticalSection();
 
-    //Decrement Semaphore since it is available
-    (*s)--;
+    G8RTOS_TRACE_EVENT(TRACE_SEM_WAIT, 0, s);
+
+    //If the semaphore is available, take it
+    if(s->value > 0)
+    {
+        s->value--;
 
-    //If the semaphore is less than zero, then thread is blocked since it is unavailable
-    if((*s) < 0)
+        //Enable Interrupts
+        EndCriticalSection(priMask);
+    }
+    else
     {
-        //Block current thread
-        CurrentlyRunningThread->blocked = s;
+        //Block current thread, the signal that wakes it hands it the semaphore
+        G8RTOS_WaitQueueInsert(&s->waiters, CurrentlyRunningThread);
 
         //Enable Interrupts
         EndCriticalSection(priMask);
@@ -57,17 +80,58 @@ void G8RTOS_WaitSemaphore(semaphore_t *s)
         //Sets PendSV flag, to yield CPU
         SCB->ICSR |= (1<<28);
     }
-    else
+}
+
+/*
+ * Waits for a semaphore for at most a number of ms
+ * 	- Decrements semaphore when available
+ * 	- Blocks in the semaphore's wait queue otherwise, the timeout waits in the sleep queue
+ * Param "s": Pointer to semaphore to wait on
+ * Param "timeout": ms to wait for, 0 to only check, WAIT_FOREVER to never time out
+ * Returns: true if the semaphore was taken, false if the timeout ran out
+ * THIS IS A CRITICAL SECTION
+ */
+bool G8RTOS_WaitSemaphoreTimeout(semaphore_t *s, uint32_t timeout)
+{
+    //Disable Interrupts
+    int32_t priMask = StartCriticalSection();
+
+    G8RTOS_TRACE_EVENT(TRACE_SEM_WAIT, 0, s);
+
+    //If the semaphore is available, take it
+    if(s->value > 0)
     {
+        s->value--;
+
         //Enable Interrupts
         EndCriticalSection(priMask);
+        return true;
+    }
+
+    //Caller only checks
+    if(timeout == 0)
+    {
+        EndCriticalSection(priMask);
+        return false;
     }
+
+    //Block current thread, the signal that wakes it hands it the semaphore
+    G8RTOS_WaitQueueInsertTimeout(&s->waiters, CurrentlyRunningThread, timeout);
+
+    //Enable Interrupts
+    EndCriticalSection(priMask);
+
+    //Sets PendSV flag, to yield CPU
+    SCB->ICSR |= (1<<28);
+
+    //Runs again once woken up, a timed out thread left the queue without the semaphore
+    return !CurrentlyRunningThread->timedOut;
 }
 
 /*
  * Signals the completion of the usage of a semaphore
- *  - Increments the semaphore value by 1
- *  - Unblocks any threads waiting on that semaphore
+ *  - Wakes the next thread in the wait queue and hands it the semaphore
+ *  - Increments the semaphore value by 1 if no thread is waiting
  * Param "s": Pointer to semaphore to be signaled
  * THIS IS A CRITICAL SECTION
  */
@@ -75,32 +139,34 @@ void G8RTOS_SignalSemaphore(semaphore_t *s)
 {
     //Disables interrupts
     int32_t priMask = StartCriticalSection();
+    G8RTOS_PROBE_START();
 
-    //Increment semaphore, to make it available
-    (*s)++;
+    G8RTOS_TRACE_EVENT(TRACE_SEM_SIGNAL, 0, s);
 
-    /*
-     * IF the semaphore is less than or equal to zero, then
-     * that means other threads are waiting on the semaphore.
-     * Other threads must be unblocked before proceeding.
-     */
-    if((*s) <= 0)
+    //If no thread was woken up, the semaphore becomes available
+    if(!G8RTOS_WaitQueueWake(&s->waiters))
     {
-        //Creates pointer to next thread
-        tcb_t *pt = CurrentlyRunningThread->next;
-
-        //While pointer is is not blocked, change thread to next
-        while(pt->blocked != s)
-        {
-            pt = pt->next;
-        }
-
-        //Once next block thread is found, it is unblocked
-        pt->blocked = 0;
+        s->value++;
     }
 
+    //Time interrupts were masked for
+    G8RTOS_PROBE_END(PROBE_SIGNAL_SEMAPHORE);
+
     //Enables interrupts
     EndCriticalSection(priMask);
 }
 
+/*
+ * Copies how often and how long threads blocked on a semaphore
+ * Param "s": Pointer to semaphore
+ * Param "stats": struct to fill
+ * THIS IS A CRITICAL SECTION
+ */
+void G8RTOS_GetSemaphoreStats(semaphore_t *s, waitStats_t *stats)
+{
+    int32_t priMask = StartCriticalSection();
+    *stats = s->waiters.stats;
+    EndCriticalSection(priMask);
+}
+
 /*********************************************** Public Functions *********************************************************************/
@@ -7,39 +7,104 @@
 
 /*********************************************** Datatype Definitions *****************************************************************/
 
+/*
+ * Order threads blocked on a kernel object are woken up in
+ *  - WAIT_FIFO: longest waiting thread first
+ *  - WAIT_PRIORITY: highest priority thread first, longest waiting first among equal priorities
+ */
+typedef enum
+{
+    WAIT_FIFO     = 0,
+    WAIT_PRIORITY = 1
+}waitOrder_t;
+
+/* Timeout that never runs out, for waits that take a timeout in ms */
+#define WAIT_FOREVER 0xFFFFFFFF
+
+/*
+ * Blocking statistics of a wait queue, counted when a thread leaves the queue
+ */
+typedef struct waitStats_t
+{
+    uint32_t waits; //Holds number of times a thread blocked in the queue
+    uint64_t blockedCycles; //Holds clock cycles threads spent blocked in the queue
+}waitStats_t;
+
+/*
+ * Wait queue typedef
+ *  - Threads blocked on a kernel object, linked through their tcb (no extra memory)
+ *  - The head is the next thread to wake up
+ */
+typedef struct waitQueue_t
+{
+    struct tcb_t *head; //Holds first thread to wake up
+    struct tcb_t *tail; //Holds last thread to wake up
+    waitOrder_t order; //Holds wake up order
+    waitStats_t stats; //Holds blocking statistics
+}waitQueue_t;
+
 /*
  * Semaphore typedef
+ *  - value never goes below 0, blocked threads wait in the wait queue instead
+ *  - A signal with threads waiting hands the unit straight to the head of the queue
  */
-typedef int32_t semaphore_t;
+typedef struct semaphore_t
+{
+    int32_t value; //Holds number of available units
+    waitQueue_t waiters; //Holds threads waiting for a unit
+}semaphore_t;
 
 /*********************************************** Datatype Definitions *****************************************************************/
-semaphore_t sensorMutex; //Semaphore used for sensor communication
-semaphore_t LCDMutex; //Semaphore used for LCD communication
 
 /*********************************************** Public Functions *********************************************************************/
 
 /*
- * Initializes a semaphore to a given value
+ * Initializes a semaphore to a given value, waiting threads wake up in FIFO order
  * Param "s": Pointer to semaphore
  * Param "value": Value to initialize semaphore to
  */
 void G8RTOS_InitSemaphore(semaphore_t *s, int32_t value);
 
+/*
+ * Initializes a semaphore to a given value with a chosen wake up order
+ * Param "s": Pointer to semaphore
+ * Param "value": Value to initialize semaphore to
+ * Param "order": WAIT_FIFO or WAIT_PRIORITY
+ */
+void G8RTOS_InitSemaphoreOrder(semaphore_t *s, int32_t value, waitOrder_t order);
+
 /*
  * Waits for a semaphore to be available (value greater than 0)
  * 	- Decrements semaphore when available
- * 	- Spinlocks to wait for semaphore
+ * 	- Blocks in the semaphore's wait queue otherwise
  * Param "s": Pointer to semaphore to wait on
  */
 void G8RTOS_WaitSemaphore(semaphore_t *s);
 
+/*
+ * Waits for a semaphore for at most a number of ms
+ * 	- Decrements semaphore when available
+ * 	- Blocks in the semaphore's wait queue otherwise, the timeout waits in the sleep queue
+ * Param "s": Pointer to semaphore to wait on
+ * Param "timeout": ms to wait for, 0 to only check, WAIT_FOREVER to never time out
+ * Returns: true if the semaphore was taken, false if the timeout ran out
+ */
+bool G8RTOS_WaitSemaphoreTimeout(semaphore_t *s, uint32_t timeout);
+
 /*
  * Signals the completion of the usage of a semaphore
- * 	- Increments the semaphore value by 1
+ * 	- Wakes the head of the wait queue, or increments the semaphore value by 1 if nothing waits
  * Param "s": Pointer to semaphore to be signalled
  */
 void G8RTOS_SignalSemaphore(semaphore_t *s);
 
+/*
+ * Copies how often and how long threads blocked on a semaphore
+ * Param "s": Pointer to semaphore
+ * Param "stats": struct to fill
+ */
+void G8RTOS_GetSemaphoreStats(semaphore_t *s, waitStats_t *stats);
+
 /*********************************************** Public Functions *********************************************************************/
 
 
@@ -0,0 +1,225 @@
+/*
+ * G8RTOS_StackPool.c
+ */
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+#include "msp.h"
+#include "BSP.h"
+#include "G8RTOS.h"
+#include <stdio.h>
+
+/*
+ * Bounds of the .stackpool region, defined in msp432p401r.cmd
+ */
+extern int32_t G8RTOS_StackPoolStart[];
+extern int32_t G8RTOS_StackPoolEnd[];
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+/*
+ * Stack size class
+ *  - Free stacks are linked through their first word
+ */
+typedef struct stackClass_t
+{
+    int32_t *freeList; //Holds first free stack
+    stackClassStats_t stats; //Holds usage
+}stackClass_t;
+
+/* Size classes, smallest first */
+static stackClass_t stackClasses[NUMBER_OF_STACK_CLASSES];
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+
+/*********************************************** Private Functions ********************************************************************/
+
+/*
+ * Carves stacks for one class from the pool
+ * Param "stackClass": class to fill
+ * Param "words": size of each stack
+ * Param "count": number of stacks wanted
+ * Param "next": next free address of the pool, moved past the stacks carved
+ */
+static void CarveClass(stackClass_t *stackClass, uint32_t words, uint32_t count, int32_t **next)
+{
+    stackClass->freeList = 0;
+    stackClass->stats.words = words;
+    stackClass->stats.total = 0;
+    stackClass->stats.inUse = 0;
+    stackClass->stats.peak = 0;
+
+    //Carves as many stacks as fit, up to count
+    while((stackClass->stats.total < count) && ((*next + words) <= G8RTOS_StackPoolEnd))
+    {
+        *(int32_t **)(*next) = stackClass->freeList;
+        stackClass->freeList = *next;
+        stackClass->stats.total++;
+        *next += words;
+    }
+}
+
+/*********************************************** Private Functions ********************************************************************/
+
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+/*
+ * Carves the linker's .stackpool region into free lists, one per size class
+ */
+void G8RTOS_StackPoolInit(void)
+{
+    int32_t *next = G8RTOS_StackPoolStart;
+
+    CarveClass(&stackClasses[0], STACK_CLASS_SMALL_WORDS, STACK_CLASS_SMALL_COUNT, &next);
+    CarveClass(&stackClasses[1], STACK_CLASS_MEDIUM_WORDS, STACK_CLASS_MEDIUM_COUNT, &next);
+    CarveClass(&stackClasses[2], STACK_CLASS_LARGE_WORDS, STACK_CLASS_LARGE_COUNT, &next);
+}
+
+/*
+ * Takes a stack from the smallest free class that holds the requested size
+ *  - Must be called inside of a critical section
+ * Param "words": stack size wanted, in words
+ * Param "actualWords": filled with the size of the stack given
+ * Returns: lowest address of the stack, 0 if no class that fits has a free stack
+ */
+int32_t *G8RTOS_StackAlloc(uint32_t words, uint32_t *actualWords)
+{
+    for(uint32_t i = 0; i < NUMBER_OF_STACK_CLASSES; ++i)
+    {
+        stackClass_t *stackClass = &stackClasses[i];
+
+        //Uses the next bigger class when this one is too small or empty
+        if((stackClass->stats.words < words) || !stackClass->freeList)
+        {
+            continue;
+        }
+
+        int32_t *stack = stackClass->freeList;
+        stackClass->freeList = *(int32_t **)stack;
+
+        stackClass->stats.inUse++;
+        if(stackClass->stats.inUse > stackClass->stats.peak)
+        {
+            stackClass->stats.peak = stackClass->stats.inUse;
+        }
+
+        *actualWords = stackClass->stats.words;
+        return stack;
+    }
+
+    return 0;
+}
+
+/*
+ * Gives a stack back to its class
+ *  - Must be called inside of a critical section
+ * Param "stack": lowest address of the stack
+ * Param "words": size the stack was given with
+ */
+void G8RTOS_StackFree(int32_t *stack, uint32_t words)
+{
+    for(uint32_t i = 0; i < NUMBER_OF_STACK_CLASSES; ++i)
+    {
+        stackClass_t *stackClass = &stackClasses[i];
+
+        if(stackClass->stats.words == words)
+        {
+            *(int32_t **)stack = stackClass->freeList;
+            stackClass->freeList = stack;
+            stackClass->stats.inUse--;
+            return;
+        }
+    }
+}
+
+/*
+ * Writes the guard word and paints the rest of a new stack
+ * Param "stack": lowest address of the stack
+ * Param "words": size of the stack
+ */
+void G8RTOS_StackPaint(int32_t *stack, uint32_t words)
+{
+    stack[0] = STACK_GUARD;
+
+    for(uint32_t i = 1; i < words; ++i)
+    {
+        stack[i] = STACK_PAINT;
+    }
+}
+
+/*
+ * Finds the high-water mark of a painted stack
+ *  - Must be called inside of a critical section
+ * Param "stack": lowest address of the stack
+ * Param "words": size of the stack
+ * Param "usage": struct to fill
+ */
+void G8RTOS_StackMeasure(int32_t *stack, uint32_t words, stackUsage_t *usage)
+{
+    uint32_t untouched = 1;
+
+    //Stack grows down, so paint left at the bottom was never reached
+    while((untouched < words) && (stack[untouched] == (int32_t)STACK_PAINT))
+    {
+        untouched++;
+    }
+
+    usage->size = words;
+    usage->guardIntact = (stack[0] == (int32_t)STACK_GUARD);
+    usage->used = usage->guardIntact ? (words - untouched) : words;
+}
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Copies the usage of every stack size class, smallest class first
+ * Param "stats": array of NUMBER_OF_STACK_CLASSES structs to fill
+ */
+void G8RTOS_GetStackPoolStats(stackClassStats_t *stats)
+{
+    int32_t priMask = StartCriticalSection();
+
+    for(uint32_t i = 0; i < NUMBER_OF_STACK_CLASSES; ++i)
+    {
+        stats[i] = stackClasses[i].stats;
+    }
+
+    EndCriticalSection(priMask);
+}
+
+/*
+ * Prints the RAM used by thread stacks to the back channel UART
+ *  - Pool size and the RAM fixed MAX_THREADS x STACKSIZE stacks would take
+ *  - RAM reclaimed, and the usage of every class
+ */
+void G8RTOS_PrintStackPoolReport(void)
+{
+    stackClassStats_t stats[NUMBER_OF_STACK_CLASSES];
+    char line[64];
+
+    G8RTOS_GetStackPoolStats(stats);
+
+    int32_t poolBytes = (G8RTOS_StackPoolEnd - G8RTOS_StackPoolStart) * 4;
+    int32_t fixedBytes = MAX_THREADS * STACKSIZE * 4;
+
+    BackChannelPrintIntVariable("stackPoolBytes", poolBytes);
+    BackChannelPrintIntVariable("fixedStackBytes", fixedBytes);
+    BackChannelPrintIntVariable("stackBytesReclaimed", fixedBytes - poolBytes);
+
+    for(uint32_t i = 0; i < NUMBER_OF_STACK_CLASSES; ++i)
+    {
+        snprintf(line, sizeof(line), "stack class %u words: %u/%u in use, peak %u",
+                 stats[i].words, stats[i].inUse, stats[i].total, stats[i].peak);
+        BackChannelPrint(line, BackChannel_Info);
+    }
+}
+
+/*********************************************** Public Functions *********************************************************************/
@@ -0,0 +1,114 @@
+/*
+ * G8RTOS_StackPool.h
+ */
+
+#ifndef G8RTOS_STACKPOOL_H_
+#define G8RTOS_STACKPOOL_H_
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+/*
+ * Stack size classes (in 32-bit words) and number of stacks of each class
+ *  - A thread gets the smallest free class that fits the stack size it asked for
+ *  - STACK_POOL_BYTES must match the size of .stackpool in msp432p401r.cmd
+ */
+#define STACK_CLASS_SMALL_WORDS   128
+#define STACK_CLASS_SMALL_COUNT   4
+#define STACK_CLASS_MEDIUM_WORDS  256
+#define STACK_CLASS_MEDIUM_COUNT  22
+#define STACK_CLASS_LARGE_WORDS   512
+#define STACK_CLASS_LARGE_COUNT   4
+#define NUMBER_OF_STACK_CLASSES   3
+
+#define STACK_POOL_BYTES ((STACK_CLASS_SMALL_WORDS * STACK_CLASS_SMALL_COUNT + \
+                           STACK_CLASS_MEDIUM_WORDS * STACK_CLASS_MEDIUM_COUNT + \
+                           STACK_CLASS_LARGE_WORDS * STACK_CLASS_LARGE_COUNT) * 4)
+
+/*
+ * Stack painting
+ *  - The lowest word of every stack is a guard, overwritten only when the stack overflows
+ *  - The rest is painted at creation, words still holding the paint were never used
+ */
+#define STACK_GUARD 0xDEADBEEF
+#define STACK_PAINT 0xA5A5A5A5
+
+/* Percent of a stack used at which G8RTOS_PrintStackUsage flags the thread */
+#define STACK_WARN_PERCENT 90
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*
+ * Usage of one stack size class
+ */
+typedef struct stackClassStats_t
+{
+    uint32_t words; //Holds size of each stack in the class
+    uint32_t total; //Holds number of stacks carved for the class
+    uint32_t inUse; //Holds number of stacks given to threads
+    uint32_t peak; //Holds most stacks in use at once
+}stackClassStats_t;
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+/*
+ * Carves the linker's .stackpool region into free lists, one per size class
+ */
+void G8RTOS_StackPoolInit(void);
+
+/*
+ * Takes a stack from the smallest free class that holds the requested size
+ *  - Must be called inside of a critical section
+ * Param "words": stack size wanted, in words
+ * Param "actualWords": filled with the size of the stack given
+ * Returns: lowest address of the stack, 0 if no class that fits has a free stack
+ */
+int32_t *G8RTOS_StackAlloc(uint32_t words, uint32_t *actualWords);
+
+/*
+ * Gives a stack back to its class
+ *  - Must be called inside of a critical section
+ * Param "stack": lowest address of the stack
+ * Param "words": size the stack was given with
+ */
+void G8RTOS_StackFree(int32_t *stack, uint32_t words);
+
+/*
+ * Writes the guard word and paints the rest of a new stack
+ * Param "stack": lowest address of the stack
+ * Param "words": size of the stack
+ */
+void G8RTOS_StackPaint(int32_t *stack, uint32_t words);
+
+/*
+ * Finds the high-water mark of a painted stack
+ *  - Must be called inside of a critical section
+ * Param "stack": lowest address of the stack
+ * Param "words": size of the stack
+ * Param "usage": struct to fill
+ */
+void G8RTOS_StackMeasure(int32_t *stack, uint32_t words, stackUsage_t *usage);
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Copies the usage of every stack size class, smallest class first
+ * Param "stats": array of NUMBER_OF_STACK_CLASSES structs to fill
+ */
+void G8RTOS_GetStackPoolStats(stackClassStats_t *stats);
+
+/*
+ * Prints the RAM used by thread stacks to the back channel UART
+ *  - Pool size and the RAM fixed MAX_THREADS x STACKSIZE stacks would take
+ *  - RAM reclaimed, and the usage of every class
+ */
+void G8RTOS_PrintStackPoolReport(void);
+
+/*********************************************** Public Functions *********************************************************************/
+
+#endif /* G8RTOS_STACKPOOL_H_ */
@@ -8,8 +8,6 @@
 #ifndef G8RTOS_STRUCTURES_H_
 #define G8RTOS_STRUCTURES_H_
 
-#define MAX_NAME_LENGTH 16
-
 #include "G8RTOS.h"
 
 /*********************************************** Data Structure Definitions ***********************************************************/
@@ -23,33 +21,66 @@
 typedef struct tcb_t
 {
     int32_t* sp; //Holds pointer to stack pointer for respective tcb_t
+    int32_t *stackBase; //Holds lowest address of the thread's stack from the stack pool
+    uint32_t stackSize; //Holds size of the thread's stack in words
     bool isAlive; //True when thread is alive
     char threadName[MAX_NAME_LENGTH]; //Holds the thread name
-    threadID_t threadID; //Unique ID
-    struct tcb_t *prev; //Holds pointer to previous tcb_t
-    struct tcb_t *next; //HOlds pointer to next tcb_t
-    uint8_t priority; //Higher number is lower priority
+    threadID_t threadID; //Unique ID, handle table index and generation
+    uint8_t priority; //Higher number is lower priority, raised above basePriority while inheriting from a mutex
+    uint8_t basePriority; //Holds priority the thread was given
     bool asleep; //True when bool is asleep
-    uint32_t sleepCount; //Holds time wanted to sleep
-    semaphore_t *blocked; // 0(not blocked) or semaphore thread  that is currently being waited for.
+    bool suspended; //True while suspended by G8RTOS_SuspendThread
+    uint32_t sleepDelta; //Holds ticks left to sleep after the thread ahead of it in the sleep queue
+    struct tcb_t *sleepPrev; //Holds previous tcb_t in the sleep queue
+    struct tcb_t *sleepNext; //Holds next tcb_t in the sleep queue, or in the G8RTOS_SleepUs queue
+    bool sleepingUs; //True while asleep in G8RTOS_SleepUs instead of the sleep queue
+    uint64_t wakeTicks; //Holds timebase tick G8RTOS_SleepUs wakes it up at
+    waitQueue_t *blocked; // 0(not blocked) or wait queue of the semaphore the thread is currently waiting for.
+    struct tcb_t *waitPrev; //Holds previous tcb_t in the wait queue it is blocked in
+    struct tcb_t *waitNext; //Holds next tcb_t in the wait queue it is blocked in
+    bool timedOut; //True if its last wait with a timeout ran out before it was woken up
+    uint32_t eventMask; //Holds event flags waited for while blocked on an event group
+    uint8_t eventOptions; //Holds EVENT_WAIT_ALL and EVENT_CLEAR_ON_EXIT options of the wait
+    uint32_t eventResult; //Holds event flags that ended the wait, 0 on timeout
+    void *waitData; //Holds data handed over by the object that woke it (memory block, message), 0 on timeout
+    waitQueue_t joiners; //Holds threads waiting in G8RTOS_JoinThread for it to end
+    mutex_t *blockedMutex; //Holds mutex the thread is waiting for, 0 otherwise
+    mutex_t *heldMutexes; //Holds list of mutexes owned by the thread
+    struct tcb_t *readyPrev; //Holds previous tcb_t in the ready list of its priority
+    struct tcb_t *readyNext; //Holds next tcb_t in the ready list of its priority
+    uint8_t sliceLeft; //Holds ticks left in its time slice
+    uint32_t edfPeriod; //Holds EDF period in ms, 0 for fixed priority threads
+    uint32_t edfDeadline; //Holds EDF deadline relative to each release
+    uint32_t edfRelease; //Holds system time the current job was released at
+    uint32_t absDeadline; //Holds system time the current job is due
+    uint32_t edfKey; //Holds deadline that orders the EDF ready list, absDeadline or an earlier one inherited through a mutex
+    edfStats_t edfStats; //Holds deadline statistics
+    uint64_t runCycles; //Holds clock cycles spent running
+    uint64_t blockedCycles; //Holds clock cycles spent blocked in wait queues
+    uint32_t blockStart; //Holds cycle count when it last blocked in a wait queue
+    uint32_t switchesIn; //Holds number of times it was switched to
+    uint64_t reportRunCycles; //Holds runCycles at the last G8RTOS_PrintThreadStats
+    uint64_t reportBlockedCycles; //Holds blockedCycles at the last G8RTOS_PrintThreadStats
+    uint32_t reportSwitchesIn; //Holds switchesIn at the last G8RTOS_PrintThreadStats
 
 }tcb_t;
 
 /*
  *  Periodic Thread Control Block:
  *      - Holds a function pointer that points to the periodic thread to be executed
- *      - Has a period in us
- *      - Holds Current time
- *      - Contains pointer to the next periodic event - linked list
+ *      - Has a period in ms
+ *      - Holds the next release time, used as the key of the periodic event min-heap
+ *      - Holds lateness statistics
  */
 typedef struct ptcb_t
 {
     void (*Handler)(void); //Function pointer
     uint32_t period; //Holds period
     uint32_t executeTime; //Holds time that will be executed
-    uint32_t currentTime; //Default starting value
-    struct ptcb_t *prev; //Holds previous periodic thread
-    struct ptcb_t *next; //Holds next periodic thread
+    periodicPolicy_t policy; //Holds what to do with missed releases
+    periodicStats_t stats; //Holds release count and lateness
+    uint32_t pending; //Holds releases waiting for the periodic worker thread
+    uint32_t releaseTime; //Holds release time of the oldest pending release
 
 }ptcb_t;
 
@@ -74,4 +105,111 @@ tcb_t *CurrentlyRunningThread;
 
 /*********************************************** Public Variables *********************************************************************/
 
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+/*
+ * Adds a thread to the tail of the ready list for its priority
+ *  - Must be called inside of a critical section
+ * Param "thread": thread that is now able to run
+ */
+void G8RTOS_ReadyInsert(tcb_t *thread);
+
+/*
+ * Removes a thread from the ready list for its priority
+ *  - Must be called inside of a critical section
+ * Param "thread": thread that is no longer able to run (asleep, blocked or killed)
+ */
+void G8RTOS_ReadyRemove(tcb_t *thread);
+
+/*
+ * Blocks a thread in a wait queue, in the queue's wake up order
+ *  - Thread must be running (in the ready list)
+ *  - Must be called inside of a critical section
+ * Param "queue": wait queue to block in
+ * Param "thread": thread to block
+ */
+void G8RTOS_WaitQueueInsert(waitQueue_t *queue, tcb_t *thread);
+
+/*
+ * Blocks a thread in a wait queue for at most a number of ms
+ *  - Thread also waits in the sleep queue, if the time runs out it leaves the wait queue with timedOut set
+ *  - Thread must be running (in the ready list)
+ *  - Must be called inside of a critical section
+ * Param "queue": wait queue to block in
+ * Param "thread": thread to block
+ * Param "timeout": ms to wait for (at least 1), WAIT_FOREVER to never time out
+ */
+void G8RTOS_WaitQueueInsertTimeout(waitQueue_t *queue, tcb_t *thread, uint32_t timeout);
+
+/*
+ * Removes a thread from the wait queue it is blocked in without readying it
+ *  - Must be called inside of a critical section
+ * Param "thread": blocked thread
+ */
+void G8RTOS_WaitQueueRemove(tcb_t *thread);
+
+/*
+ * Wakes the head of a wait queue and puts it back into the ready list
+ *  - Must be called inside of a critical section
+ * Param "queue": wait queue to wake from
+ * Returns: thread woken up, 0 if queue was empty
+ */
+tcb_t *G8RTOS_WaitQueueWake(waitQueue_t *queue);
+
+/*
+ * Wakes a thread blocked in a wait queue and puts it back into the ready list
+ *  - Cancels its timeout
+ *  - Must be called inside of a critical section
+ * Param "thread": blocked thread
+ */
+void G8RTOS_WaitQueueWakeThread(tcb_t *thread);
+
+/*
+ * Changes the priority a thread is scheduled with
+ *  - Moves the thread in its ready list or priority ordered wait queue
+ *  - Must be called inside of a critical section
+ * Param "thread": thread to change
+ * Param "priority": new effective priority
+ */
+void G8RTOS_SetEffectivePriority(tcb_t *thread, uint8_t priority);
+
+/*
+ * Changes the deadline an EDF thread is ordered by
+ *  - Moves the thread in the EDF ready list or priority ordered wait queue it is in
+ *  - Must be called inside of a critical section
+ * Param "thread": EDF thread to change
+ * Param "deadline": new effective deadline, in system time
+ */
+void G8RTOS_SetEffectiveDeadline(tcb_t *thread, uint32_t deadline);
+
+/*
+ * Cleans up the mutexes of a thread being killed
+ *  - Stops its priority from being inherited by the owner of the mutex it waited for
+ *  - Hands every mutex it owns to the next waiter
+ *  - Must be called inside of a critical section, after the thread left its wait queue
+ * Param "thread": thread being killed
+ */
+void G8RTOS_MutexKillThread(tcb_t *thread);
+
+/*
+ * Applies a change of a thread's base priority
+ *  - Recomputes the thread's priority from its base priority and the mutexes it owns
+ *  - Updates the priority the owner of the mutex it waits for inherits
+ *  - Must be called inside of a critical section
+ * Param "thread": thread whose base priority changed
+ */
+void G8RTOS_MutexPriorityChanged(tcb_t *thread);
+
+/*
+ * Copies the ID and name of the thread in a handle table slot
+ * Param "index": slot in the handle table
+ * Param "threadID": filled with the thread's ID, its generation is above the slot
+ * Param "name": buffer of MAX_NAME_LENGTH chars to fill
+ * Returns: false if no live thread is in the slot
+ */
+bool G8RTOS_GetSlotThread(uint32_t index, threadID_t *threadID, char *name);
+
+/*********************************************** Kernel Functions *********************************************************************/
+
 #endif /* G8RTOS_STRUCTURES_H_ */
@@ -0,0 +1,332 @@
+/*
+ * G8RTOS_Time.c
+ */
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+#include "msp.h"
+#include "G8RTOS.h"
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+#if G8RTOS_HIRES_TIME
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+/* Holds number of times the Timer32 1 timebase wrapped, the upper 32 bits of the 64-bit time */
+static volatile uint32_t timebaseWraps;
+
+/* Threads sleeping in G8RTOS_SleepUs, earliest wake up time first, linked through sleepNext */
+static tcb_t *sleepUsQueue;
+
+/* Holds G8RTOS_SleepUs statistics, lateness in timebase ticks until copied out */
+static sleepUsStats_t sleepUsStats;
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+
+/*********************************************** Private Functions ********************************************************************/
+
+/*
+ * Timebase wrap interrupt
+ *  - Only counts wraps, G8RTOS_GetTimeTicks also accounts for a wrap whose interrupt is still pending
+ */
+static void TimebaseWrap(void)
+{
+    TIMER32_1->INTCLR = 0;
+    timebaseWraps++;
+}
+
+/*
+ * Arms the wake up timer for the head of the G8RTOS_SleepUs queue
+ *  - One-shot, stops itself in its interrupt
+ *  - Wake ups further away than the timer reaches are armed for as far as it reaches and re-armed from there
+ *  - Must be called inside of a critical section
+ */
+static void ArmWakeTimer(void)
+{
+    TIMER_A1->CTL = TIMER_A_CTL_SSEL__SMCLK | TIMER_A_CTL_MC__STOP | TIMER_A_CTL_CLR;
+    TIMER_A1->CCTL[0] = 0;
+
+    if(!sleepUsQueue)
+    {
+        return;
+    }
+
+    uint64_t now = G8RTOS_GetTimeTicks();
+    uint32_t counts = 1;
+
+    if(sleepUsQueue->wakeTicks > now)
+    {
+        uint64_t ticks = sleepUsQueue->wakeTicks - now;
+        counts = (ticks < (WAKE_MAX_COUNTS / WAKE_COUNTS_PER_TICK)) ? (uint32_t)ticks * WAKE_COUNTS_PER_TICK : WAKE_MAX_COUNTS;
+    }
+
+    TIMER_A1->CCR[0] = counts;
+    TIMER_A1->CCTL[0] = TIMER_A_CCTLN_CCIE;
+    TIMER_A1->CTL = TIMER_A_CTL_SSEL__SMCLK | TIMER_A_CTL_MC__UP;
+}
+
+/*
+ * Links a thread into the G8RTOS_SleepUs queue by wake up time, re-arms the wake up timer if it is the new head
+ *  - Threads with the same wake up time wake in the order they went to sleep in
+ *  - Must be called inside of a critical section
+ */
+static void SleepUsInsert(tcb_t *thread)
+{
+    tcb_t **link = &sleepUsQueue;
+
+    while(*link && ((*link)->wakeTicks <= thread->wakeTicks))
+    {
+        link = &(*link)->sleepNext;
+    }
+
+    thread->sleepNext = *link;
+    *link = thread;
+
+    if(sleepUsQueue == thread)
+    {
+        ArmWakeTimer();
+    }
+}
+
+/*
+ * Wake up timer interrupt
+ *  - Readies every thread whose wake up time has passed, then arms the timer for the next one
+ *  - Runs at OSINT_PRIORITY like SysTick, so neither interrupts the other halfway through the ready lists
+ */
+static void WakeTimer(void)
+{
+    int32_t priMask = StartCriticalSection();
+
+    TIMER_A1->CTL = TIMER_A_CTL_SSEL__SMCLK | TIMER_A_CTL_MC__STOP;
+    TIMER_A1->CCTL[0] &= ~TIMER_A_CCTLN_CCIFG;
+
+    uint64_t now = G8RTOS_GetTimeTicks();
+
+    while(sleepUsQueue && (sleepUsQueue->wakeTicks <= now))
+    {
+        tcb_t *thread = sleepUsQueue;
+        sleepUsQueue = thread->sleepNext;
+
+        thread->asleep = false;
+        thread->sleepingUs = false;
+
+        //Lateness of the wake up
+        uint32_t late = (uint32_t)(now - thread->wakeTicks);
+        sleepUsStats.lastLateUs = late;
+        if(late > sleepUsStats.maxLateUs)
+        {
+            sleepUsStats.maxLateUs = late;
+        }
+
+        G8RTOS_ReadyInsert(thread);
+        G8RTOS_TRACE_EVENT(TRACE_WAKE, thread, 2);
+
+        //Equal priorities also reschedule, a woken EDF thread may be due before the running one
+        if(thread->priority <= CurrentlyRunningThread->priority)
+        {
+            SCB->ICSR |= (1<<28);
+        }
+    }
+
+    ArmWakeTimer();
+
+    EndCriticalSection(priMask);
+}
+
+/*
+ * Sleeps the current thread until a timebase tick
+ *  - Spins if the wake up time is less than SLEEP_US_SPIN us away
+ */
+static void SleepUntilTicks(uint64_t wakeTicks)
+{
+    int32_t priMask = StartCriticalSection();
+
+    //Too close to be worth two context switches
+    if(wakeTicks <= G8RTOS_GetTimeTicks() + (SLEEP_US_SPIN * TIMEBASE_TICKS_PER_US))
+    {
+        sleepUsStats.spins++;
+        EndCriticalSection(priMask);
+
+        while(G8RTOS_GetTimeTicks() < wakeTicks);
+        return;
+    }
+
+    //Sleeping thread cannot be scheduled and waits in the G8RTOS_SleepUs queue
+    CurrentlyRunningThread->asleep = true;
+    CurrentlyRunningThread->sleepingUs = true;
+    CurrentlyRunningThread->wakeTicks = wakeTicks;
+    G8RTOS_ReadyRemove(CurrentlyRunningThread);
+    SleepUsInsert(CurrentlyRunningThread);
+
+    sleepUsStats.sleeps++;
+    G8RTOS_TRACE_EVENT(TRACE_SLEEP, 0, (uint32_t)((wakeTicks - G8RTOS_GetTimeTicks()) / TIMEBASE_TICKS_PER_US));
+
+    EndCriticalSection(priMask);
+
+    //Sets PendSV flag, to yield CPU
+    SCB->ICSR |= (1<<28);
+}
+
+/*********************************************** Private Functions ********************************************************************/
+
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+/*
+ * Starts the Timer32 1 timebase and sets up the Timer_A1 wake up timer
+ *  - Called by G8RTOS_Init
+ */
+void G8RTOS_TimeInit(void)
+{
+    timebaseWraps = 0;
+    sleepUsQueue = 0;
+    sleepUsStats.sleeps = 0;
+    sleepUsStats.spins = 0;
+    sleepUsStats.lastLateUs = 0;
+    sleepUsStats.maxLateUs = 0;
+
+    //Free running 32-bit down counter at MCLK/16, interrupts when it wraps
+    TIMER32_1->CONTROL = 0;
+    TIMER32_1->LOAD = 0xFFFFFFFF;
+    TIMER32_1->INTCLR = 0;
+
+    __NVIC_SetVector(T32_INT1_IRQn, (uint32_t)TimebaseWrap);
+    __NVIC_SetPriority(T32_INT1_IRQn, OSINT_PRIORITY);
+    __NVIC_EnableIRQ(T32_INT1_IRQn);
+
+    TIMER32_1->CONTROL = TIMER32_CONTROL_SIZE | TIMER32_CONTROL_PRESCALE_1 | TIMER32_CONTROL_IE | TIMER32_CONTROL_ENABLE;
+
+    //Wake up timer stays stopped until a thread sleeps on it
+    TIMER_A1->CTL = TIMER_A_CTL_SSEL__SMCLK | TIMER_A_CTL_MC__STOP | TIMER_A_CTL_CLR;
+    TIMER_A1->CCTL[0] = 0;
+
+    __NVIC_SetVector(TA1_0_IRQn, (uint32_t)WakeTimer);
+    __NVIC_SetPriority(TA1_0_IRQn, OSINT_PRIORITY);
+    __NVIC_EnableIRQ(TA1_0_IRQn);
+}
+
+/*
+ * Takes a thread out of the G8RTOS_SleepUs queue without readying it
+ *  - The wake up timer is left armed, if the thread was the head the interrupt finds nothing due and re-arms
+ *  - Must be called inside of a critical section
+ * Param "thread": thread sleeping in G8RTOS_SleepUs
+ */
+void G8RTOS_SleepUsRemove(tcb_t *thread)
+{
+    tcb_t **link = &sleepUsQueue;
+
+    while(*link != thread)
+    {
+        link = &(*link)->sleepNext;
+    }
+
+    *link = thread->sleepNext;
+    thread->sleepingUs = false;
+}
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Returns timebase ticks since G8RTOS_Init, TIMEBASE_TICKS_PER_US per us
+ *  - Reads the wrap count around the counter and retries if the wrap interrupt ran in between
+ *  - A wrap whose interrupt has not run yet (masked or lower priority) is counted from the raw flag
+ */
+uint64_t G8RTOS_GetTimeTicks(void)
+{
+    uint32_t wraps;
+    uint32_t high;
+    uint32_t low;
+
+    do
+    {
+        wraps = timebaseWraps;
+        high = wraps;
+        low = ~TIMER32_1->VALUE;
+
+        //Counter wrapped but the wrap is not counted yet, reads it again so it is from after the wrap
+        if(TIMER32_1->RIS & TIMER32_RIS_RAW_IFG)
+        {
+            low = ~TIMER32_1->VALUE;
+            high++;
+        }
+    }
+    while(wraps != timebaseWraps);
+
+    return ((uint64_t)high << 32) | low;
+}
+
+/*
+ * Returns us since G8RTOS_Init
+ */
+uint64_t G8RTOS_GetTimeUs(void)
+{
+    return G8RTOS_GetTimeTicks() / TIMEBASE_TICKS_PER_US;
+}
+
+/*
+ * Puts the current thread to sleep for a number of us
+ *  - Wake up time is fixed on entry, time spent sleeping whole ticks or preempted counts towards it
+ *  - Waits of SLEEP_US_TICK_THRESHOLD us and more first sleep in the SysTick sleep queue until 1 to 2ms are left
+ *    so the wake up timer is free for short waits most of the time
+ * Param "us": us to sleep for
+ */
+void G8RTOS_SleepUs(uint32_t us)
+{
+    uint64_t wakeTicks = G8RTOS_GetTimeTicks() + ((uint64_t)us * TIMEBASE_TICKS_PER_US);
+
+    if(us >= SLEEP_US_TICK_THRESHOLD)
+    {
+        G8RTOS_Sleep((us / 1000) - 1);
+    }
+
+    SleepUntilTicks(wakeTicks);
+}
+
+/*
+ * Puts the current thread to sleep until an absolute time
+ * Param "wakeUs": G8RTOS_GetTimeUs value to wake up at, returns at once if it has already passed
+ */
+void G8RTOS_SleepUntilUs(uint64_t wakeUs)
+{
+    uint64_t now = G8RTOS_GetTimeUs();
+
+    if(wakeUs <= now)
+    {
+        return;
+    }
+
+    //Long waits sleep whole ticks first like G8RTOS_SleepUs
+    if((wakeUs - now) >= SLEEP_US_TICK_THRESHOLD)
+    {
+        G8RTOS_Sleep((uint32_t)((wakeUs - now) / 1000) - 1);
+    }
+
+    SleepUntilTicks(wakeUs * TIMEBASE_TICKS_PER_US);
+}
+
+/*
+ * Copies the G8RTOS_SleepUs statistics, then restarts the lateness ones
+ * Param "stats": struct to fill
+ */
+void G8RTOS_GetSleepUsStats(sleepUsStats_t *stats)
+{
+    int32_t priMask = StartCriticalSection();
+
+    stats->sleeps = sleepUsStats.sleeps;
+    stats->spins = sleepUsStats.spins;
+    stats->lastLateUs = sleepUsStats.lastLateUs / TIMEBASE_TICKS_PER_US;
+    stats->maxLateUs = sleepUsStats.maxLateUs / TIMEBASE_TICKS_PER_US;
+
+    sleepUsStats.maxLateUs = 0;
+
+    EndCriticalSection(priMask);
+}
+
+/*********************************************** Public Functions *********************************************************************/
+
+#endif
@@ -0,0 +1,106 @@
+/*
+ * G8RTOS_Time.h
+ */
+
+#ifndef G8RTOS_TIME_H_
+#define G8RTOS_TIME_H_
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+/*
+ * Timebase clock
+ *  - Timer32 1 counts MCLK (48MHz) divided by 16, 3 ticks per us
+ *  - Extended to 64 bits by counting its wraps, it would take about 195000 years to wrap, so 64-bit times
+ *    are compared directly
+ */
+#define TIMEBASE_TICKS_PER_US 3
+
+/*
+ * Wake up timer clock
+ *  - Timer_A1 counts SMCLK (12MHz), 4 counts per timebase tick
+ *  - Its 16-bit compare reaches about 5.4ms, later wake ups are armed in steps
+ */
+#define WAKE_COUNTS_PER_TICK 4
+#define WAKE_MAX_COUNTS 0xFFFF
+
+/*
+ * Waits shorter than this (in us) spin on the timebase, two context switches would take about as long
+ */
+#define SLEEP_US_SPIN 20
+
+/*
+ * Waits of at least this many us sleep whole SysTick ticks first, only the last part uses the wake up timer
+ */
+#define SLEEP_US_TICK_THRESHOLD 2000
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*
+ * G8RTOS_SleepUs statistics
+ *  - Lateness is the time from a thread's wake up time to the wake up interrupt readying it
+ */
+typedef struct sleepUsStats_t
+{
+    uint32_t sleeps; //Holds number of waits that blocked on the wake up timer
+    uint32_t spins; //Holds number of waits short enough to spin
+    uint32_t lastLateUs; //Holds lateness of the last wake up
+    uint32_t maxLateUs; //Holds worst lateness seen
+}sleepUsStats_t;
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+/*
+ * Starts the Timer32 1 timebase and sets up the Timer_A1 wake up timer
+ *  - Called by G8RTOS_Init
+ */
+void G8RTOS_TimeInit(void);
+
+/*
+ * Takes a thread out of the G8RTOS_SleepUs queue without readying it
+ *  - Must be called inside of a critical section
+ * Param "thread": thread sleeping in G8RTOS_SleepUs
+ */
+void G8RTOS_SleepUsRemove(tcb_t *thread);
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Returns timebase ticks since G8RTOS_Init, TIMEBASE_TICKS_PER_US per us
+ *  - Can be called from threads and interrupts of any priority
+ */
+uint64_t G8RTOS_GetTimeTicks(void);
+
+/*
+ * Returns us since G8RTOS_Init
+ *  - Can be called from threads and interrupts of any priority
+ */
+uint64_t G8RTOS_GetTimeUs(void);
+
+/*
+ * Puts the current thread to sleep for a number of us
+ *  - Short waits spin, long waits sleep whole ticks first and finish on the wake up timer
+ * Param "us": us to sleep for
+ */
+void G8RTOS_SleepUs(uint32_t us);
+
+/*
+ * Puts the current thread to sleep until an absolute time
+ * Param "wakeUs": G8RTOS_GetTimeUs value to wake up at, returns at once if it has already passed
+ */
+void G8RTOS_SleepUntilUs(uint64_t wakeUs);
+
+/*
+ * Copies the G8RTOS_SleepUs statistics, then restarts the lateness ones
+ * Param "stats": struct to fill
+ */
+void G8RTOS_GetSleepUsStats(sleepUsStats_t *stats);
+
+/*********************************************** Public Functions *********************************************************************/
+
+#endif /* G8RTOS_TIME_H_ */
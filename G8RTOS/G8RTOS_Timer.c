@@ -0,0 +1,216 @@
+/*
+ * G8RTOS_Timer.c
+ */
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+#include "msp.h"
+#include "G8RTOS.h"
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+/*********************************************** Defines ******************************************************************************/
+
+/* Flag set in timerEvents when the earliest expiry may have changed */
+#define TIMER_LIST_CHANGED 0x01
+
+/*********************************************** Defines ******************************************************************************/
+
+#if G8RTOS_TIMERS
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+/* Active timers, earliest expiry first */
+static swTimer_t *activeTimers;
+
+/* Wakes the timer thread when a timer is started ahead of the list head */
+static eventGroup_t timerEvents;
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+
+/*********************************************** Private Functions ********************************************************************/
+
+/*
+ * Links a timer into the active list by expiry
+ *  - Timers with the same expiry fire in the order they were started
+ *  - Must be called inside of a critical section
+ */
+static void ActiveInsert(swTimer_t *timer)
+{
+    swTimer_t **link = &activeTimers;
+
+    while(*link && !TIME_BEFORE(timer->expiry, (*link)->expiry))
+    {
+        link = &(*link)->next;
+    }
+
+    timer->next = *link;
+    *link = timer;
+    timer->active = true;
+}
+
+/*
+ * Unlinks an active timer
+ *  - Must be called inside of a critical section
+ */
+static void ActiveRemove(swTimer_t *timer)
+{
+    swTimer_t **link = &activeTimers;
+
+    while(*link != timer)
+    {
+        link = &(*link)->next;
+    }
+
+    *link = timer->next;
+    timer->active = false;
+}
+
+/*
+ * Timer thread
+ *  - Sleeps until the earliest expiry, or until a timer is started ahead of it
+ *  - Calls the callbacks of every expired timer in expiry order, then re-arms auto-reload timers
+ */
+static void TimerThread(void)
+{
+    while(1)
+    {
+        int32_t priMask = StartCriticalSection();
+
+        //Fires every expired timer
+        while(activeTimers && TIME_REACHED(SystemTime, activeTimers->expiry))
+        {
+            swTimer_t *timer = activeTimers;
+            void (*callback)(void *arg) = timer->callback;
+            void *arg = timer->arg;
+
+            ActiveRemove(timer);
+
+            //Auto-reload timers keep their phase, releases missed while callbacks ran late are skipped
+            if(timer->period)
+            {
+                do
+                {
+                    timer->expiry += timer->period;
+                }
+                while(TIME_REACHED(SystemTime, timer->expiry));
+
+                ActiveInsert(timer);
+            }
+
+            timer->fired++;
+
+            //Callback may start or stop timers, so the list is only walked inside of the critical section
+            EndCriticalSection(priMask);
+            callback(arg);
+            priMask = StartCriticalSection();
+        }
+
+        uint32_t wait = activeTimers ? (activeTimers->expiry - SystemTime) : WAIT_FOREVER;
+
+        EndCriticalSection(priMask);
+
+        //Blocks until the next expiry, a start ahead of it ends the wait early
+        G8RTOS_WaitEvents(&timerEvents, TIMER_LIST_CHANGED, EVENT_WAIT_ANY | EVENT_CLEAR_ON_EXIT, wait);
+    }
+}
+
+/*********************************************** Private Functions ********************************************************************/
+
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+/*
+ * Starts the kernel timer thread
+ *  - Called by G8RTOS_Init
+ */
+void G8RTOS_TimerServiceInit(void)
+{
+    activeTimers = 0;
+    G8RTOS_InitEventGroup(&timerEvents);
+    G8RTOS_AddThread(TimerThread, TIMER_THREAD_PRIORITY, 256, "TIMER");
+}
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Initializes a stopped timer
+ * Param "timer": Pointer to timer
+ * Param "callback": function called from the timer thread when the timer expires, must not block for long
+ * Param "arg": argument passed to the callback
+ * Param "period": ms between firings of an auto-reload timer, 0 for a one-shot timer
+ */
+void G8RTOS_InitTimer(swTimer_t *timer, void (*callback)(void *arg), void *arg, uint32_t period)
+{
+    timer->callback = callback;
+    timer->arg = arg;
+    timer->period = period;
+    timer->expiry = 0;
+    timer->active = false;
+    timer->fired = 0;
+    timer->next = 0;
+}
+
+/*
+ * Starts a timer, or restarts it if it is already active
+ *  - Can be called from interrupts
+ * Param "timer": Pointer to timer
+ * Param "delay": ms until the first firing (at least 1)
+ * THIS IS A CRITICAL SECTION
+ */
+void G8RTOS_StartTimer(swTimer_t *timer, uint32_t delay)
+{
+    int32_t priMask = StartCriticalSection();
+
+    if(timer->active)
+    {
+        ActiveRemove(timer);
+    }
+
+    timer->expiry = SystemTime + (delay ? delay : 1);
+    ActiveInsert(timer);
+
+    //Timer thread sleeps until the old head expires, so a new head wakes it to sleep less
+    if(activeTimers == timer)
+    {
+        G8RTOS_SetEvents(&timerEvents, TIMER_LIST_CHANGED);
+    }
+
+    EndCriticalSection(priMask);
+}
+
+/*
+ * Stops a timer, its callback is not called again until it is restarted
+ *  - A stopped head only makes the timer thread wake up once for nothing, so it is not woken
+ *  - Can be called from interrupts
+ * Param "timer": Pointer to timer
+ * THIS IS A CRITICAL SECTION
+ */
+void G8RTOS_StopTimer(swTimer_t *timer)
+{
+    int32_t priMask = StartCriticalSection();
+
+    if(timer->active)
+    {
+        ActiveRemove(timer);
+    }
+
+    EndCriticalSection(priMask);
+}
+
+/*
+ * Returns true while a timer is active
+ * Param "timer": Pointer to timer
+ */
+bool G8RTOS_TimerActive(swTimer_t *timer)
+{
+    return timer->active;
+}
+
+/*********************************************** Public Functions *********************************************************************/
+
+#endif
@@ -0,0 +1,73 @@
+/*
+ * G8RTOS_Timer.h
+ */
+
+#ifndef G8RTOS_TIMER_H_
+#define G8RTOS_TIMER_H_
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*
+ * Software timer typedef
+ *  - Calls its callback from the kernel timer thread once it expires
+ *  - One-shot timers (period 0) stop after firing, auto-reload timers fire every period ms
+ *  - Active timers are linked in a list ordered by expiry
+ */
+typedef struct swTimer_t
+{
+    void (*callback)(void *arg); //Holds function called when the timer expires
+    void *arg; //Holds argument passed to the callback
+    uint32_t period; //Holds ms between firings, 0 for a one-shot timer
+    uint32_t expiry; //Holds system time the timer fires at next
+    bool active; //True while the timer is in the active list
+    uint32_t fired; //Holds number of times the callback was called
+    struct swTimer_t *next; //Holds next timer to expire
+}swTimer_t;
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+/*
+ * Starts the kernel timer thread
+ *  - Called by G8RTOS_Init
+ */
+void G8RTOS_TimerServiceInit(void);
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Initializes a stopped timer
+ * Param "timer": Pointer to timer
+ * Param "callback": function called from the timer thread when the timer expires, must not block for long
+ * Param "arg": argument passed to the callback
+ * Param "period": ms between firings of an auto-reload timer, 0 for a one-shot timer
+ */
+void G8RTOS_InitTimer(swTimer_t *timer, void (*callback)(void *arg), void *arg, uint32_t period);
+
+/*
+ * Starts a timer, or restarts it if it is already active
+ *  - Can be called from interrupts
+ * Param "timer": Pointer to timer
+ * Param "delay": ms until the first firing (at least 1)
+ */
+void G8RTOS_StartTimer(swTimer_t *timer, uint32_t delay);
+
+/*
+ * Stops a timer, its callback is not called again until it is restarted
+ *  - Can be called from interrupts
+ * Param "timer": Pointer to timer
+ */
+void G8RTOS_StopTimer(swTimer_t *timer);
+
+/*
+ * Returns true while a timer is active
+ * Param "timer": Pointer to timer
+ */
+bool G8RTOS_TimerActive(swTimer_t *timer);
+
+/*********************************************** Public Functions *********************************************************************/
+
+#endif /* G8RTOS_TIMER_H_ */
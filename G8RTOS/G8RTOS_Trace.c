@@ -0,0 +1,186 @@
+/*
+ * G8RTOS_Trace.c
+ */
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+#include "msp.h"
+#include "BSP.h"
+#include "G8RTOS.h"
+#include <stdio.h>
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+extern tcb_t * CurrentlyRunningThread;
+
+/*********************************************** Defines ******************************************************************************/
+
+/* Records printed on one back channel line */
+#define TRACE_RECORDS_PER_LINE 8
+
+/*********************************************** Defines ******************************************************************************/
+
+#if G8RTOS_TRACE
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+/* Trace Ring
+ *  - TRACE_BUFFER_SIZE records, traceHead is the next one written
+ *  - Oldest records are overwritten once it is full
+ */
+static traceRecord_t traceBuffer[TRACE_BUFFER_SIZE];
+static uint32_t traceHead;
+
+/* Records written since the last dump */
+static uint32_t traceCount;
+
+/* False while the ring is being dumped */
+static bool traceEnabled = true;
+
+/* Records dropped while the ring was being dumped, reported by the next dump */
+static uint32_t traceDropped;
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+#endif
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Adds a record to the trace ring, overwriting the oldest record once it is full
+ *  - Can be called from interrupts
+ * Param "event": kind of record
+ * Param "thread": tcb the event is about, 0 for the running thread
+ * Param "arg": event argument, only the low 16 bits are kept
+ * THIS IS A CRITICAL SECTION
+ */
+void G8RTOS_TraceRecord(traceEvent_t event, tcb_t *thread, uint32_t arg)
+{
+#if G8RTOS_TRACE
+    int32_t priMask = StartCriticalSection();
+
+    if(traceEnabled)
+    {
+        traceRecord_t *record = &traceBuffer[traceHead];
+
+        if(!thread)
+        {
+            thread = CurrentlyRunningThread;
+        }
+
+        record->cycles = DWT->CYCCNT;
+        record->event = event;
+        record->thread = thread ? (thread->threadID & 0xFF) : TRACE_NO_THREAD;
+        record->arg = arg;
+
+        traceHead = (traceHead + 1) % TRACE_BUFFER_SIZE;
+        traceCount++;
+    }
+    else
+    {
+        traceDropped++;
+    }
+
+    EndCriticalSection(priMask);
+#endif
+}
+
+/*
+ * Records that a thread was added to a handle table slot, with its generation and name
+ *  - The name goes into the ring two chars per record, so a dump can name threads that have since been killed
+ * Param "thread": new thread
+ * THIS IS A CRITICAL SECTION
+ */
+void G8RTOS_TraceThreadStart(tcb_t *thread)
+{
+#if G8RTOS_TRACE
+    //Keeps the name records right behind the start record
+    int32_t priMask = StartCriticalSection();
+
+    G8RTOS_TraceRecord(TRACE_THREAD_START, thread, thread->threadID >> 8);
+
+    for(uint32_t i = 0; i < MAX_NAME_LENGTH; i += 2)
+    {
+        char first = thread->threadName[i];
+        char second = first ? thread->threadName[i + 1] : 0;
+
+        G8RTOS_TraceRecord(TRACE_THREAD_NAME, thread, (uint8_t)first | ((uint8_t)second << 8));
+
+        if(!first || !second)
+        {
+            break;
+        }
+    }
+
+    EndCriticalSection(priMask);
+#endif
+}
+
+/*
+ * Drains the trace ring to the back channel UART, oldest record first, then empties it
+ *  - Recording stops while the ring is printed, records that come in meanwhile are counted as dropped
+ *  - Live threads are listed with their generation, earlier threads of a slot are named by their TRACE_THREAD_NAME records
+ */
+void G8RTOS_TraceDump(void)
+{
+#if G8RTOS_TRACE
+    char line[24 + (TRACE_RECORDS_PER_LINE * 17)];
+    char name[MAX_NAME_LENGTH];
+
+    //Stops recording so the ring holds still
+    int32_t priMask = StartCriticalSection();
+    traceEnabled = false;
+    uint32_t count = (traceCount < TRACE_BUFFER_SIZE) ? traceCount : TRACE_BUFFER_SIZE;
+    uint32_t lost = traceCount - count;
+    uint32_t dropped = traceDropped;
+    uint32_t index = (traceHead + TRACE_BUFFER_SIZE - count) % TRACE_BUFFER_SIZE;
+    EndCriticalSection(priMask);
+
+    snprintf(line, sizeof(line), "trace clock %u", (unsigned)ClockSys_GetSysFreq());
+    BackChannelPrint(line, BackChannel_Info);
+
+    //Names for the thread slots in the records
+    for(uint32_t slot = 0; slot < MAX_THREADS; ++slot)
+    {
+        threadID_t threadID;
+
+        if(G8RTOS_GetSlotThread(slot, &threadID, name))
+        {
+            snprintf(line, sizeof(line), "trace thread %u %u %s", (unsigned)slot, (unsigned)(threadID >> 8), name);
+            BackChannelPrint(line, BackChannel_Info);
+        }
+    }
+
+    while(count)
+    {
+        uint32_t length = snprintf(line, sizeof(line), "trace data");
+
+        for(uint32_t i = 0; (i < TRACE_RECORDS_PER_LINE) && count; ++i, --count)
+        {
+            traceRecord_t *record = &traceBuffer[index];
+            index = (index + 1) % TRACE_BUFFER_SIZE;
+
+            length += snprintf(&line[length], sizeof(line) - length, " %08x%02x%02x%04x",
+                               (unsigned)record->cycles, (unsigned)record->event,
+                               (unsigned)record->thread, (unsigned)record->arg);
+        }
+
+        BackChannelPrint(line, BackChannel_Info);
+    }
+
+    snprintf(line, sizeof(line), "trace end %u %u", (unsigned)lost, (unsigned)dropped);
+    BackChannelPrint(line, BackChannel_Info);
+
+    //Empties ring and starts recording again, records dropped while printing are reported next time
+    priMask = StartCriticalSection();
+    traceHead = 0;
+    traceCount = 0;
+    traceDropped -= dropped;
+    traceEnabled = true;
+    EndCriticalSection(priMask);
+#else
+    BackChannelPrint("trace disabled, build with G8RTOS_TRACE 1", BackChannel_Warning);
+#endif
+}
+
+/*********************************************** Public Functions *********************************************************************/
@@ -0,0 +1,98 @@
+/*
+ * G8RTOS_Trace.h
+ */
+
+#ifndef G8RTOS_TRACE_H_
+#define G8RTOS_TRACE_H_
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*
+ * Kinds of trace records
+ *  - Values are part of the dump format read by tools/trace2chrome.py
+ */
+typedef enum
+{
+    TRACE_SWITCH     = 1, //thread: thread switched to, arg: slot of thread switched from
+    TRACE_SEM_WAIT   = 2, //thread: waiting thread, arg: low 16 bits of the semaphore's address
+    TRACE_SEM_SIGNAL = 3, //thread: signalling thread, arg: low 16 bits of the semaphore's address
+    TRACE_SLEEP      = 4, //thread: sleeping thread, arg: ms to sleep (us from G8RTOS_SleepUs)
+    TRACE_WAKE       = 5, //thread: woken thread, arg: 0 from the sleep queue, 1 from a wait queue, 2 from the G8RTOS_SleepUs queue
+    TRACE_ISR_ENTER  = 6, //thread: interrupted thread, arg: exception number
+    TRACE_ISR_EXIT   = 7, //thread: interrupted thread, arg: exception number
+    TRACE_FIFO_READ  = 8, //thread: reading thread, arg: FIFO index
+    TRACE_FIFO_WRITE = 9, //thread: writing thread, arg: FIFO index
+    TRACE_THREAD_START = 10, //thread: new thread, arg: generation of its slot, followed by its TRACE_THREAD_NAME records
+    TRACE_THREAD_NAME  = 11  //thread: new thread, arg: next two chars of its name, low byte first, ends at a 0 char
+}traceEvent_t;
+
+/*
+ * Trace record, 8 bytes
+ */
+typedef struct traceRecord_t
+{
+    uint32_t cycles; //Holds DWT cycle count when the event happened
+    uint8_t event; //Holds traceEvent_t
+    uint8_t thread; //Holds handle table slot of the thread, TRACE_NO_THREAD before launch
+    uint16_t arg; //Holds event argument
+}traceRecord_t;
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+/* Thread slot recorded when no thread is running yet */
+#define TRACE_NO_THREAD 0xFF
+
+/*
+ * Records a trace event, compiles to nothing unless G8RTOS_TRACE is 1
+ *  - "thread" is the tcb the event is about, 0 for the running thread
+ */
+#if G8RTOS_TRACE
+#define G8RTOS_TRACE_EVENT(event, thread, arg) G8RTOS_TraceRecord((event), (thread), (uint32_t)(arg))
+#define G8RTOS_TRACE_ISR_ENTER() G8RTOS_TraceRecord(TRACE_ISR_ENTER, 0, __get_IPSR())
+#define G8RTOS_TRACE_ISR_EXIT() G8RTOS_TraceRecord(TRACE_ISR_EXIT, 0, __get_IPSR())
+#define G8RTOS_TRACE_THREAD_START(thread) G8RTOS_TraceThreadStart(thread)
+#else
+#define G8RTOS_TRACE_EVENT(event, thread, arg)
+#define G8RTOS_TRACE_ISR_ENTER()
+#define G8RTOS_TRACE_ISR_EXIT()
+#define G8RTOS_TRACE_THREAD_START(thread)
+#endif
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Adds a record to the trace ring, overwriting the oldest record once it is full
+ *  - Can be called from interrupts
+ * Param "event": kind of record
+ * Param "thread": tcb the event is about, 0 for the running thread
+ * Param "arg": event argument, only the low 16 bits are kept
+ */
+void G8RTOS_TraceRecord(traceEvent_t event, tcb_t *thread, uint32_t arg);
+
+/*
+ * Records that a thread was added to a handle table slot, with its generation and name
+ *  - Slots are reused, so records are matched to the thread that had the slot when they were written
+ *  - Must be called once the thread's ID and name are set
+ * Param "thread": new thread
+ */
+void G8RTOS_TraceThreadStart(tcb_t *thread);
+
+/*
+ * Drains the trace ring to the back channel UART, oldest record first, then empties it
+ *  - Recording stops while the ring is printed, records that come in meanwhile are counted as dropped
+ *  - Called every TRACE_DUMP_PERIOD ms by the monitor thread
+ *  - Lines, read by tools/trace2chrome.py:
+ *      "trace clock <Hz>"
+ *      "trace thread <slot> <generation> <name>" for every live thread
+ *      "trace data <hex>..." with up to TRACE_RECORDS_PER_LINE records, each as hex cycles(8) event(2) thread(2) arg(4)
+ *      "trace end <records lost to overwriting> <records dropped while the previous dump printed>"
+ */
+void G8RTOS_TraceDump(void);
+
+/*********************************************** Public Functions *********************************************************************/
+
+#endif /* G8RTOS_TRACE_H_ */
@@ -332,7 +332,7 @@ inline uint16_t TP_ReadReg(uint8_t LCD_Reg)
     P4->IE &= ~BIT0;
 
     //Draws rectangle
-    G8RTOS_WaitSemaphore(&LCDMutex);
+    G8RTOS_LockMutex(&LCDMutex);
 
     SPI_CS_TP_LOW;
 
@@ -348,7 +348,7 @@ inline uint16_t TP_ReadReg(uint8_t LCD_Reg)
     SPI_CS_TP_HIGH;
 
     //Draws rectangle
-    G8RTOS_SignalSemaphore(&LCDMutex);
+    G8RTOS_UnlockMutex(&LCDMutex);
 
     //Turns on interrupt for P4.0
     P4->IFG &= ~BIT0;
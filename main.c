@@ -9,26 +9,57 @@ void main(void)
     //Initialize G8RTOS
     G8RTOS_Init();
 
+    //Create tap event group before the touch interrupt can set it
+    G8RTOS_InitEventGroup(&tapEvents);
+
     //Initialize LCD_Tap as new Handler
     G8RTOS_AddAPeriodicEvent(LCD_Tap, 125, PORT4_IRQn);
 
     //Initialize LCD and TP
     LCD_Init(true);
 
-    //Create ball FIFO
-    G8RTOS_InitFIFO(BALLFIFO);
+    //Create ball spawn queue
+    G8RTOS_InitMsgQueue(&spawnQueue, spawnSlots, sizeof(Point), SPAWN_QUEUE_SIZE);
+
+    //Initializing Mutexes
+    G8RTOS_InitMutex(&sensorMutex, MUTEX_INHERIT, 0);
+    G8RTOS_InitMutex(&LCDMutex, MUTEX_INHERIT, 0);
 
-    //Initializing Semaphores
-    G8RTOS_InitSemaphore(&sensorMutex, 1);
-    G8RTOS_InitSemaphore(&LCDMutex, 1);
+    //Reads the accelerometer from the timer thread instead of a thread of its own
+    G8RTOS_InitTimer(&accelTimer, readAccelerometer, 0, ACCEL_PERIOD);
+    G8RTOS_StartTimer(&accelTimer, ACCEL_PERIOD);
 
     //Creating threads
-    char name2[] = "READ";
-    G8RTOS_AddThread(readAccelerometer, 125, name2);
-    char name1[] = "WAIT";
-    G8RTOS_AddThread(waitForTap, 125, name1);
     char name3[] = "IDLE";
-    G8RTOS_AddThread(idle, 255, name3);
+    G8RTOS_AddThread(idle, 255, 128, name3);
+
+#if !G8RTOS_SCHED_BENCHMARK
+    //Ball demo, left out of scheduler benchmark builds so G8RTOS_SleepBenchmark has its 20 thread slots
+    char name1[] = "WAIT";
+    G8RTOS_AddThread(waitForTap, 125, 512, name1);
+
+#if DEMO_TAP_REPORT
+    //Prints tap to wake and tap to spawn latency
+    char name5[] = "TAPREPORT";
+    G8RTOS_AddThread(tapReport, 200, 256, name5);
+#endif
+#endif
+
+#if DEMO_BENCHMARKS
+    //Runs the benchmarks built in once
+    char name6[] = "BENCH";
+    G8RTOS_AddThread(runBenchmarks, BENCH_PRIORITY, 512, name6);
+#endif
+
+#if DEMO_PERIODIC_LOAD
+    //Gives SysTick periodic work so the deferred and inline builds can be compared
+    G8RTOS_AddPeriodicEvent(periodicLoad, LOAD_PERIOD);
+    char name4[] = "TICKREPORT";
+    G8RTOS_AddThread(tickReport, 200, 256, name4);
+#endif
+
+    //RAM the stack pool reclaimed against fixed stacks, and the classes' usage after startup
+    G8RTOS_PrintStackPoolReport();
 
     //Start GatorOS
     G8RTOS_Launch();
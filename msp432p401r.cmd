@@ -124,6 +124,11 @@ SECTIONS
     .data   :   > SRAM_DATA
     .bss    :   > SRAM_DATA
     .sysmem :   > SRAM_DATA
+
+    /* G8RTOS thread stack pool, carved into size classes at G8RTOS_Init     */
+    /* Size must match STACK_POOL_BYTES in G8RTOS_StackPool.h                 */
+    .stackpool : { . += 0x8000; } > SRAM_DATA, type = NOINIT, palign(8),
+                 RUN_START(G8RTOS_StackPoolStart), RUN_END(G8RTOS_StackPoolEnd)
     .stack  :   > SRAM_DATA (HIGH)
 
 #ifdef  __TI_COMPILER_VERSION__
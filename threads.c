@@ -15,6 +15,8 @@
 
 #define BALLSIDE 5
 #define HITBOX 20
+#define BALL_PERIOD 30 //ms between ball frames, also the deadline of each frame
+#define TAP_DEBOUNCE 200 //ms the touch pad is left to settle after a tap
 
 /*
  * Global values for accelerometer
@@ -23,7 +25,13 @@ int16_t accelX;
 int16_t accelY;
 
 volatile uint16_t NumberOfBalls = 0; //Holds number of balls
-volatile bool touch = false; //If screen is pressed
+
+eventGroup_t tapEvents; //Holds TAP_EVENT, set when screen is pressed
+static volatile uint32_t tapCycles; //Holds cycle count of the last tap interrupt
+static tapLatency_t tapLatency; //Holds tap to wake and tap to spawn latency
+
+msgQueue_t spawnQueue; //Holds spawn points, one message per ball
+MSGQUEUE_BUFFER(spawnSlots, sizeof(Point), SPAWN_QUEUE_SIZE);
 
 /*
  * Holds all balls
@@ -31,38 +39,35 @@ volatile bool touch = false; //If screen is pressed
 static ball_t balls[MAXBALLS];
 
 
+swTimer_t accelTimer; //Fires readAccelerometer every ACCEL_PERIOD ms
+
 /*
  * Reads accelerometer values and saves them to globals
+ *  - Callback of accelTimer, runs in the kernel timer thread
  */
-void readAccelerometer(void)
+void readAccelerometer(void *arg)
 {
-    while(true)
-    {
-        //Waits for sensor I2C semaphore
-        G8RTOS_WaitSemaphore(&sensorMutex);
+    //Locks sensor I2C mutex
+    G8RTOS_LockMutex(&sensorMutex);
 
-        //Reads accelerometer
-        bmi160_read_accel_x(&accelX);
+    //Reads accelerometer
+    bmi160_read_accel_x(&accelX);
 
-        //Releases Sensor
-        G8RTOS_SignalSemaphore(&sensorMutex);
+    //Releases Sensor
+    G8RTOS_UnlockMutex(&sensorMutex);
 
 
-        //Waits for sensor I2C semaphore
-        G8RTOS_WaitSemaphore(&sensorMutex);
+    //Locks sensor I2C mutex
+    G8RTOS_LockMutex(&sensorMutex);
 
-        //Reads accelerometer
-        bmi160_read_accel_y(&accelY);
+    //Reads accelerometer
+    bmi160_read_accel_y(&accelY);
 
-        //Negative to account for sensor orientation
-        accelY *= -1;
+    //Negative to account for sensor orientation
+    accelY *= -1;
 
-        //Releases Sensor
-        G8RTOS_SignalSemaphore(&sensorMutex);
-
-        //Sleeps 100ms
-        G8RTOS_Sleep(100);
-    }
+    //Releases Sensor
+    G8RTOS_UnlockMutex(&sensorMutex);
 }
 
 /*
@@ -77,11 +82,17 @@ void waitForTap(void)
     char name[] = "BALL";
     while(1)
     {
-        //IF screen is pressed
-        if(touch)
+        //Blocks until the screen is pressed
+        if(G8RTOS_WaitEvents(&tapEvents, TAP_EVENT, EVENT_WAIT_ANY | EVENT_CLEAR_ON_EXIT, WAIT_FOREVER))
         {
-            //Turns off flag
-            touch = false;
+            //Cycles from the tap interrupt until this thread ran
+            uint32_t cycles = DWT->CYCCNT - tapCycles;
+            tapLatency.taps++;
+            tapLatency.lastWakeCycles = cycles;
+            if(cycles > tapLatency.maxWakeCycles)
+            {
+                tapLatency.maxWakeCycles = cycles;
+            }
 
             //Reads coordinates
             Point p = TP_ReadXY();
@@ -99,10 +110,10 @@ void waitForTap(void)
                     //Touch was on a ball
                     ballTouch = true;
 
-                    //Waits for LCD semaphore in case that thread to be deleted is using it
-                    G8RTOS_WaitSemaphore(&LCDMutex);
+                    //Locks LCD mutex in case that thread to be deleted is using it
+                    G8RTOS_LockMutex(&LCDMutex);
                     uint8_t code = G8RTOS_KillThread(balls[i].threadID);
-                    G8RTOS_SignalSemaphore(&LCDMutex);
+                    G8RTOS_UnlockMutex(&LCDMutex);
 
                     //If removal was successful then decrement balls and kill it
                     if(!code)
@@ -112,34 +123,74 @@ void waitForTap(void)
                     }
 
                     //Draws rectangle
-                    G8RTOS_WaitSemaphore(&LCDMutex);
+                    G8RTOS_LockMutex(&LCDMutex);
                     LCD_DrawRectangle(balls[i].xPos,
                                       balls[i].xPos + BALLSIDE,
                                       balls[i].yPos,
                                       balls[i].yPos + BALLSIDE,
                                       LCD_BLACK);
-                    G8RTOS_SignalSemaphore(&LCDMutex);
+                    G8RTOS_UnlockMutex(&LCDMutex);
                     break;
                 }
             }
 
-            //IF touch was not on a ball and on the screen
-            if(!ballTouch && (p.x <= MAX_SCREEN_X) && (p.y <= MAX_SCREEN_Y))
+            //IF touch was not on a ball, on the screen and there is room for another ball
+            if(!ballTouch && (p.x <= MAX_SCREEN_X) && (p.y <= MAX_SCREEN_Y) && (NumberOfBalls < MAXBALLS))
             {
                 //If adding thread was a success
-                if(!G8RTOS_AddThread(ball, 125, name))
+                if(!G8RTOS_AddThread(ball, 125, 256, name))
                 {
-                    //Writes the FIFO coordinates to array and increments number
-                    writeFIFO(BALLFIFO, p.x);
-                    writeFIFO(BALLFIFO, p.y);
+                    //Sends the coordinates as one message and increments number
+                    G8RTOS_MsgSend(&spawnQueue, &p, WAIT_FOREVER);
                     NumberOfBalls++;
+
+                    //Cycles from the tap interrupt until the ball was spawned
+                    cycles = DWT->CYCCNT - tapCycles;
+                    tapLatency.lastSpawnCycles = cycles;
+                    if(cycles > tapLatency.maxSpawnCycles)
+                    {
+                        tapLatency.maxSpawnCycles = cycles;
+                    }
                 }
             }
         }
-        G8RTOS_Sleep(500);
+
+        //Lets the touch pad settle, then drops taps it bounced while being handled
+        G8RTOS_Sleep(TAP_DEBOUNCE);
+        G8RTOS_ClearEvents(&tapEvents, TAP_EVENT);
     }
 }
 
+/*
+ * Copies the tap latency statistics, then restarts the worst cases
+ *  - waitForTap writes them, the critical section keeps the copy from being torn by a tap
+ */
+void getTapLatency(tapLatency_t *latency)
+{
+    int32_t priMask = StartCriticalSection();
+
+    *latency = tapLatency;
+    tapLatency.maxWakeCycles = 0;
+    tapLatency.maxSpawnCycles = 0;
+
+    EndCriticalSection(priMask);
+}
+
+/*
+ * Prints the tap latency statistics to the back channel UART, then restarts the worst cases
+ *  - Blocks on the UART, so it is meant for a low priority thread, not the tap path
+ */
+void printTapLatency(void)
+{
+    tapLatency_t latency;
+
+    getTapLatency(&latency);
+
+    BackChannelPrintIntVariable("taps", latency.taps);
+    BackChannelPrintIntVariable("tapWakeMaxCycles", latency.maxWakeCycles);
+    BackChannelPrintIntVariable("tapSpawnMaxCycles", latency.maxSpawnCycles);
+}
+
 /*
  * Funtion that represents a ball
  */
@@ -157,13 +208,26 @@ void ball(void)
     }
 
     //Instantiates new ball to add
-    balls[index].xPos = readFIFO(BALLFIFO);
-    balls[index].yPos = readFIFO(BALLFIFO);
+    Point start;
+    G8RTOS_MsgReceive(&spawnQueue, &start, WAIT_FOREVER);
+
+    //No free ball left, drops its spawn point and kills itself instead of writing past balls
+    if(index == MAXBALLS)
+    {
+        NumberOfBalls--;
+        G8RTOS_KillSelf();
+    }
+
+    balls[index].xPos = start.x;
+    balls[index].yPos = start.y;
     balls[index].xVel = (rand() % 10) - 5;
     balls[index].yVel = (rand() % 10) - 5;
     balls[index].color = rand() % 65536;
     balls[index].threadID = G8RTOS_GetThreadID();
 
+    //Each frame is an EDF job due by the next frame
+    G8RTOS_SetEDF(BALL_PERIOD, BALL_PERIOD);
+
     while(1)
     {
         //Saves old coordinates
@@ -195,7 +259,7 @@ void ball(void)
         }
 
         //Erases old rectangle and draws new rectangle
-        G8RTOS_WaitSemaphore(&LCDMutex);
+        G8RTOS_LockMutex(&LCDMutex);
         LCD_DrawRectangle(xTemp,
                           xTemp + BALLSIDE,
                           yTemp,
@@ -206,18 +270,91 @@ void ball(void)
                           balls[index].yPos,
                           balls[index].yPos + BALLSIDE,
                           balls[index].color);
-        G8RTOS_SignalSemaphore(&LCDMutex);
+        G8RTOS_UnlockMutex(&LCDMutex);
 
-        G8RTOS_Sleep(30);
+        //Sleeps until the next frame is released
+        G8RTOS_WaitNextPeriod();
     }
 }
 
+#if DEMO_TAP_REPORT
+/*
+ * Prints the tap latency statistics every TAP_REPORT_PERIOD ms
+ *  - Low priority, the UART prints stay off the tap path
+ */
+void tapReport(void)
+{
+    while(1)
+    {
+        G8RTOS_Sleep(TAP_REPORT_PERIOD);
+        printTapLatency();
+    }
+}
+#endif
+
+#if DEMO_BENCHMARKS
+/*
+ * Runs every benchmark built in once, prints the results and kills itself
+ *  - G8RTOS_SCHED_BENCHMARK: scheduler against the linear scan with 4, 23 (MAX_THREADS before the kernel's threads)
+ *    and 64 threads, then SysTick with 0, 5, 10 and 20 threads asleep
+ *  - DEMO_MEMPOOL_BENCHMARK: pool against malloc alloc/free pairs
+ *  - DEMO_SPSC_BENCHMARK: SPSC ring against FIFO push/pop pairs
+ */
+void runBenchmarks(void)
+{
+#if G8RTOS_SCHED_BENCHMARK
+    G8RTOS_SchedulerBenchmark(4);
+    G8RTOS_SchedulerBenchmark(23);
+    G8RTOS_SchedulerBenchmark(64);
+    G8RTOS_SleepBenchmark();
+#endif
+
+#if DEMO_MEMPOOL_BENCHMARK
+    G8RTOS_MemPoolBenchmark(MEMPOOL_BENCH_ITERATIONS);
+#endif
+
+#if DEMO_SPSC_BENCHMARK
+    G8RTOS_SPSCBenchmark(SPSC_BENCH_ITERATIONS);
+#endif
+
+    G8RTOS_KillSelf();
+}
+#endif
+
+#if DEMO_PERIODIC_LOAD
+/*
+ * Periodic event that stands in for a sensor read, busy-waits LOAD_CYCLES cycles
+ *  - Runs inside SysTick_Handler, or in the kernel worker thread with G8RTOS_DEFERRED_PERIODIC
+ */
+void periodicLoad(void)
+{
+    uint32_t start = DWT->CYCCNT;
+    while((DWT->CYCCNT - start) < LOAD_CYCLES);
+}
+
+/*
+ * Prints the longest SysTick_Handler every TICK_REPORT_PERIOD ms
+ */
+void tickReport(void)
+{
+    while(1)
+    {
+        G8RTOS_Sleep(TICK_REPORT_PERIOD);
+        BackChannelPrintIntVariable("tickMaxCycles", G8RTOS_GetTickMaxCycles());
+    }
+}
+#endif
+
 /*
  * Idle thread that runs when others do not
  */
 void idle(void)
 {
-    while(1) {}
+    while(1)
+    {
+        //Sleeps the CPU until the next deadline when the kernel is built tickless
+        G8RTOS_Idle();
+    }
 }
 
 /*
@@ -225,8 +362,14 @@ void idle(void)
  */
 void LCD_Tap(void)
 {
+    G8RTOS_TRACE_ISR_ENTER();
+
     //Clear IFG flag
     P4->IFG &= ~BIT0;
 
-    touch = true;
+    //Wakes waitForTap
+    tapCycles = DWT->CYCCNT;
+    G8RTOS_SetEvents(&tapEvents, TAP_EVENT);
+
+    G8RTOS_TRACE_ISR_EXIT();
 }
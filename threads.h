@@ -8,25 +8,154 @@
 #ifndef THREADS_H_
 #define THREADS_H_
 
-#define BALLFIFO 0
+#define ACCEL_PERIOD 100 //ms between accelerometer reads
+#define SPAWN_QUEUE_SIZE 4 //Spawn requests that can wait for their ball thread
+
+/*
+ * Demo periodic load
+ *  - 1: main adds periodicLoad as a LOAD_PERIOD ms periodic event and tickReport, so the longest
+ *       SysTick_Handler can be compared between G8RTOS_DEFERRED_PERIODIC builds
+ *  - 0: the demo has no periodic events
+ */
+#ifndef DEMO_PERIODIC_LOAD
+#define DEMO_PERIODIC_LOAD 0
+#endif
+
+#define LOAD_PERIOD 10 //ms between periodicLoad releases
+#define LOAD_CYCLES 4800 //Cycles periodicLoad busy-waits for, 100us at 48MHz
+#define TICK_REPORT_PERIOD 1000 //ms between tickReport prints
+
+/*
+ * Demo tap latency report
+ *  - 1: main adds tapReport, which prints the tap latency statistics every TAP_REPORT_PERIOD ms
+ *  - 0: tap latency is only kept for getTapLatency
+ */
+#ifndef DEMO_TAP_REPORT
+#define DEMO_TAP_REPORT 1
+#endif
+
+#define TAP_REPORT_PERIOD 1000 //ms between tapReport prints
+
+/*
+ * Memory pool benchmark
+ *  - 1: runBenchmarks times MEMPOOL_BENCH_ITERATIONS alloc/free pairs on a pool and on malloc (G8RTOS_MemPoolBenchmark)
+ *  - 0: not run
+ */
+#ifndef DEMO_MEMPOOL_BENCHMARK
+#define DEMO_MEMPOOL_BENCHMARK 0
+#endif
+
+#define MEMPOOL_BENCH_ITERATIONS 1000
+
+/*
+ * SPSC ring benchmark
+ *  - 1: runBenchmarks times SPSC_BENCH_ITERATIONS push/pop pairs on a ring and on a FIFO (G8RTOS_SPSCBenchmark),
+ *       the demo uses no FIFOs so the one it reinitializes is free
+ *  - 0: not run
+ */
+#ifndef DEMO_SPSC_BENCHMARK
+#define DEMO_SPSC_BENCHMARK 0
+#endif
+
+#define SPSC_BENCH_ITERATIONS 1000
+
+/*
+ * Benchmarks
+ *  - With G8RTOS_SCHED_BENCHMARK or a DEMO_*_BENCHMARK option, main adds runBenchmarks, which runs the
+ *    enabled benchmarks once and kills itself
+ *  - G8RTOS_SleepBenchmark needs 20 free thread slots, so scheduler benchmark builds leave out waitForTap and tapReport
+ */
+#define DEMO_BENCHMARKS (G8RTOS_SCHED_BENCHMARK || DEMO_MEMPOOL_BENCHMARK || DEMO_SPSC_BENCHMARK)
+
+#define BENCH_PRIORITY 150 //Priority of runBenchmarks, below the demo's threads
+
+/* Event flag LCD_Tap sets in tapEvents */
+#define TAP_EVENT 0x01
+
+/*
+ * Tap latency, in clock cycles from the touch interrupt
+ *  - Wake: until waitForTap runs
+ *  - Spawn: until the ball's spawn point is queued, includes reading the touch pad and checking for a hit ball
+ */
+typedef struct tapLatency_t
+{
+    uint32_t taps; //Holds number of taps measured
+    uint32_t lastWakeCycles; //Holds wake latency of the last tap
+    uint32_t maxWakeCycles; //Holds worst wake latency
+    uint32_t lastSpawnCycles; //Holds spawn latency of the last tap that spawned a ball
+    uint32_t maxSpawnCycles; //Holds worst spawn latency
+}tapLatency_t;
+
+/*
+ * Event group the touch interrupt signals waitForTap through
+ */
+extern eventGroup_t tapEvents;
+
+/*
+ * Message queue waitForTap hands each new ball its (x, y) start through
+ */
+extern msgQueue_t spawnQueue;
+extern uint32_t spawnSlots[];
+
+/*
+ * Auto-reload timer that reads the accelerometer
+ */
+extern swTimer_t accelTimer;
 
 
 
 /*
  * Reads accelerometer values and saves them to globals
+ *  - Callback of accelTimer, runs in the kernel timer thread
  */
-void readAccelerometer(void);
+void readAccelerometer(void *arg);
 
 /*
  * Waits for screen to be tapped then attempts to add a ball thread
  */
 void waitForTap(void);
 
+/*
+ * Copies the tap latency statistics, then restarts the worst cases
+ */
+void getTapLatency(tapLatency_t *latency);
+
+/*
+ * Prints the tap latency statistics to the back channel UART, then restarts the worst cases
+ */
+void printTapLatency(void);
+
 /*
  * Funtion that represents a ball
  */
 void ball(void);
 
+#if DEMO_TAP_REPORT
+/*
+ * Prints the tap latency statistics every TAP_REPORT_PERIOD ms
+ */
+void tapReport(void);
+#endif
+
+#if DEMO_BENCHMARKS
+/*
+ * Runs every benchmark built in once, prints the results and kills itself
+ */
+void runBenchmarks(void);
+#endif
+
+#if DEMO_PERIODIC_LOAD
+/*
+ * Periodic event that stands in for a sensor read, busy-waits LOAD_CYCLES cycles
+ */
+void periodicLoad(void);
+
+/*
+ * Prints the longest SysTick_Handler every TICK_REPORT_PERIOD ms
+ */
+void tickReport(void);
+#endif
+
 /*
  * Idle thread that runs when others do not
  */
@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+"""
+trace2chrome.py
+
+Converts a G8RTOS trace dump (G8RTOS_TraceDump) captured from the back channel UART
+into Chrome trace JSON, viewable in chrome://tracing or https://ui.perfetto.dev
+
+Usage: trace2chrome.py <uart log> [output.json]
+"""
+
+import json
+import re
+import sys
+
+# Record kinds, must match traceEvent_t in G8RTOS_Trace.h
+TRACE_SWITCH = 1
+TRACE_SEM_WAIT = 2
+TRACE_SEM_SIGNAL = 3
+TRACE_SLEEP = 4
+TRACE_WAKE = 5
+TRACE_ISR_ENTER = 6
+TRACE_ISR_EXIT = 7
+TRACE_FIFO_READ = 8
+TRACE_FIFO_WRITE = 9
+TRACE_THREAD_START = 10
+TRACE_THREAD_NAME = 11
+
+TRACE_NO_THREAD = 0xFF
+
+# Track ISRs are drawn on
+ISR_TID = 1000
+
+INSTANT_NAMES = {
+    TRACE_SEM_WAIT: "sem wait",
+    TRACE_SEM_SIGNAL: "sem signal",
+    TRACE_SLEEP: "sleep",
+    TRACE_WAKE: "wake",
+    TRACE_FIFO_READ: "fifo read",
+    TRACE_FIFO_WRITE: "fifo write",
+}
+
+# Back channel lines look like { "info" : "trace data ..." }
+LINE = re.compile(r'"info"\s*:\s*"(trace [^"]*)"')
+
+
+def parse(lines):
+    """Reads the last dump in a log, returns clock, live threads ({slot: (generation, name)}), records and losses"""
+    clock = 48000000
+    names = {}
+    records = []
+    lost = 0
+    dropped = 0
+
+    for line in lines:
+        match = LINE.search(line)
+        if not match:
+            continue
+        words = match.group(1).split()
+
+        if words[1] == "clock":
+            # A new dump starts
+            clock = int(words[2])
+            names = {}
+            records = []
+        elif words[1] == "thread":
+            names[int(words[2])] = (int(words[3]), " ".join(words[4:]))
+        elif words[1] == "data":
+            for word in words[2:]:
+                records.append((int(word[0:8], 16), int(word[8:10], 16),
+                                int(word[10:12], 16), int(word[12:16], 16)))
+        elif words[1] == "end":
+            lost = int(words[2])
+            dropped = int(words[3]) if len(words) > 3 else 0
+
+    return clock, names, records, lost, dropped
+
+
+def incarnations(names, records):
+    """Splits handle table slots into the threads that used them
+
+    Slots are reused once a thread is killed, a TRACE_THREAD_START record starts a new thread in its slot.
+    Returns the Chrome track of every record's thread and the name of every track.
+    """
+    tracks = {}
+    labels = {}
+    started = {}
+    nextTrack = [0]
+
+    def new_track(slot, label):
+        track = nextTrack[0]
+        nextTrack[0] += 1
+        tracks[slot] = track
+        labels[track] = label
+        return track
+
+    # Threads that had their slot before the oldest record, the live thread unless the slot was reused since
+    restarted = {thread for _, event, thread, _ in records if event == TRACE_THREAD_START}
+    for slot, (generation, name) in names.items():
+        if slot not in restarted:
+            new_track(slot, "%s (%d)" % (name, slot))
+
+    recordTracks = []
+    for _, event, thread, arg in records:
+        if thread == TRACE_NO_THREAD:
+            recordTracks.append(ISR_TID)
+            continue
+
+        if event == TRACE_THREAD_START:
+            track = new_track(thread, "thread %d gen %d" % (thread, arg))
+            started[track] = (thread, arg, "")
+        elif event == TRACE_THREAD_NAME and tracks.get(thread) in started:
+            track = tracks[thread]
+            slot, generation, name = started[track]
+            for char in (arg & 0xFF, arg >> 8):
+                if char:
+                    name += chr(char)
+            started[track] = (slot, generation, name)
+            labels[track] = "%s (%d)" % (name, slot)
+        elif thread not in tracks:
+            new_track(thread, "earlier thread (%d)" % thread)
+
+        recordTracks.append(tracks[thread])
+
+    return recordTracks, labels
+
+
+def convert(clock, names, records):
+    """Builds the Chrome trace event list"""
+    events = []
+    usPerCycle = 1e6 / clock
+
+    recordTracks, labels = incarnations(names, records)
+
+    for track in sorted(labels):
+        events.append({"ph": "M", "name": "thread_name", "pid": 0, "tid": track,
+                       "args": {"name": labels[track]}})
+    events.append({"ph": "M", "name": "thread_name", "pid": 0, "tid": ISR_TID,
+                   "args": {"name": "interrupts"}})
+
+    # Unwraps the 32-bit cycle counter
+    base = 0
+    last = None
+    running = None
+    runStart = 0.0
+
+    for (cycles, event, thread, arg), track in zip(records, recordTracks):
+        if last is not None and cycles < last:
+            base += 1 << 32
+        last = cycles
+        ts = (base + cycles) * usPerCycle
+
+        if event == TRACE_SWITCH:
+            # Closes the slice of the thread switched out
+            if running is not None:
+                events.append({"ph": "X", "name": labels[running], "pid": 0, "tid": running,
+                               "ts": runStart, "dur": ts - runStart})
+            running = track
+            runStart = ts
+        elif event == TRACE_ISR_ENTER:
+            events.append({"ph": "B", "name": "exception %d" % arg, "pid": 0, "tid": ISR_TID, "ts": ts})
+        elif event == TRACE_ISR_EXIT:
+            events.append({"ph": "E", "name": "exception %d" % arg, "pid": 0, "tid": ISR_TID, "ts": ts})
+        elif event in INSTANT_NAMES:
+            events.append({"ph": "i", "s": "t", "name": INSTANT_NAMES[event], "pid": 0, "tid": track,
+                           "ts": ts, "args": {"arg": arg}})
+
+    # Thread still running at the end of the dump
+    if running is not None and last is not None:
+        events.append({"ph": "X", "name": labels[running], "pid": 0, "tid": running,
+                       "ts": runStart, "dur": (base + last) * usPerCycle - runStart})
+
+    return events
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+
+    with open(sys.argv[1], errors="replace") as log:
+        clock, names, records, lost, dropped = parse(log)
+
+    if not records:
+        sys.exit("no trace records found in " + sys.argv[1])
+
+    output = sys.argv[2] if len(sys.argv) > 2 else "trace.json"
+    with open(output, "w") as out:
+        json.dump({"traceEvents": convert(clock, names, records), "displayTimeUnit": "ns"}, out)
+
+    print("%d records, %d threads, %d lost to overwriting, %d dropped while dumping -> %s"
+          % (len(records), len(names), lost, dropped, output))
+
+
+if __name__ == "__main__":
+    main()